@@ -0,0 +1,42 @@
+//
+//  ArrivalSchedule.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include "ArrivalSchedule.hpp"
+
+/// Share of a frame's delay over the schedule absorbed by the schedule. Keeps
+/// the schedule on the lower envelope of the arrivals while following slow
+/// changes of the network delay.
+static constexpr double envelopeDrift = .01;
+
+/// Weight of a new interval in the smoothed frame period
+static constexpr double periodSmoothing = .05;
+
+double ArrivalSchedule::schedule(const unsigned long &generation, const double &arrival) {
+	if(!_started) {
+		_period = 0;
+		_anchorGeneration = generation;
+		_anchorTime = arrival;
+		_started = true;
+	} else if(generation > _anchorGeneration) {
+		const double interval = (arrival - _anchorTime) / (generation - _anchorGeneration);
+		_period = _period == 0 ? interval : _period + (interval - _period) * periodSmoothing;
+	}
+
+	// Where the frame would be without any jitter
+	const double expected = _anchorTime + (double(generation) - double(_anchorGeneration)) * _period;
+
+	_advance = arrival < expected ? expected - arrival : 0;
+
+	const double scheduled = arrival < expected ? arrival : expected + (arrival - expected) * envelopeDrift;
+
+	if(generation >= _anchorGeneration) {
+		_anchorGeneration = generation;
+		_anchorTime = scheduled;
+	}
+
+	return scheduled;
+}
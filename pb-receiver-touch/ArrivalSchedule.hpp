@@ -0,0 +1,55 @@
+//
+//  ArrivalSchedule.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef ArrivalSchedule_hpp
+#define ArrivalSchedule_hpp
+
+/// Estimates when frames would arrive if the network had no jitter.
+///
+/// The stream carries no send time, so the schedule is extrapolated from the
+/// previous frame with the smoothed interval between frames, and follows the
+/// lower envelope of the arrivals: frames ahead of the schedule move it forward
+/// right away, frames behind it only pull it back slowly. The distance between
+/// a frame's arrival and its schedule is the delay it took over the fastest
+/// transit seen.
+class ArrivalSchedule {
+public:
+
+	/// Forgets the schedule, the next frame starts a new one
+	inline void reset() {
+		_started = false;
+	}
+
+	/// Schedules the frame of the given generation, arrived at `arrival`, and
+	/// returns its jitter-free arrival. The result is never after `arrival`.
+	double schedule(const unsigned long &generation, const double &arrival);
+
+	/// How far ahead of the schedule the last frame arrived, 0 if it was not
+	inline double advance() const {
+		return _advance;
+	}
+
+	/// Smoothed interval between two generations, in seconds
+	inline double period() const {
+		return _period;
+	}
+
+private:
+
+	double _period = 0;
+
+	/// Last scheduled frame, and its scheduled arrival
+	unsigned long _anchorGeneration = 0;
+	double _anchorTime = 0;
+
+	double _advance = 0;
+
+	/// Tells if a frame has been scheduled since the last reset
+	bool _started = false;
+};
+
+#endif /* ArrivalSchedule_hpp */
@@ -0,0 +1,268 @@
+//
+//  BodyFusion.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "BodyFusion.hpp"
+
+/// Joints anchoring the bodies
+static constexpr size_t neckJoint = 1;
+static constexpr size_t torsoJoint = 8;
+
+/// Bits of each cell coordinate in a cell key
+static constexpr unsigned cellBits = 21;
+
+void BodyFusion::resize(const size_t &capacity) {
+	_anchorX.resize(capacity);
+	_anchorY.resize(capacity);
+	_anchorZ.resize(capacity);
+	_anchored.resize(capacity);
+	_fusedInto.resize(capacity);
+
+	_cells.reserve(capacity);
+	_group.reserve(capacity);
+	_previousUIDs.reserve(capacity);
+	_currentUIDs.reserve(capacity);
+	_givenUIDs.reserve(capacity);
+	_frameUIDs.reserve(capacity);
+}
+
+void BodyFusion::fuse(Frame &frame) {
+	_fusedBodies = 0;
+
+	if(_radius <= 0) {
+		_previousUIDs.clear();
+		return;
+	}
+
+	if(frame.capacity() > _fusedInto.size())
+		resize(frame.capacity());
+
+	// Bin the anchored bodies in the grid
+	const float cellScale = 1.f / _radius;
+	_cells.clear();
+
+	for(unsigned b = 0; b < frame.bodyCount; ++b) {
+		_fusedInto[b] = b;
+		_anchored[b] = anchor(frame, b);
+
+		if(!_anchored[b])
+			continue;
+
+		_cells.emplace_back(cellKey(std::floor(_anchorX[b] * cellScale),
+									std::floor(_anchorY[b] * cellScale),
+									std::floor(_anchorZ[b] * cellScale)), b);
+	}
+
+	std::sort(_cells.begin(), _cells.end());
+
+	const float radius2 = _radius * _radius;
+	const auto isBefore = [] (const std::pair<std::uint64_t, unsigned> &cell, const std::uint64_t &key) {
+		return cell.first < key;
+	};
+
+	_currentUIDs.clear();
+	_givenUIDs.clear();
+
+	_frameUIDs.assign(frame.uids.begin(), frame.uids.begin() + frame.bodyCount);
+	std::sort(_frameUIDs.begin(), _frameUIDs.end());
+
+	// Each body not fused yet is kept, and takes in the bodies around it. The
+	// kept bodies are moved up in the frame as we go.
+	unsigned kept = 0;
+
+	for(unsigned b = 0; b < frame.bodyCount; ++b) {
+		if(_fusedInto[b] != b)
+			continue;
+
+		_group.clear();
+		_group.push_back(b);
+
+		if(_anchored[b]) {
+			const std::int64_t x = std::floor(_anchorX[b] * cellScale);
+			const std::int64_t y = std::floor(_anchorY[b] * cellScale);
+			const std::int64_t z = std::floor(_anchorZ[b] * cellScale);
+
+			// Cells are as large as the radius, the bodies in range are in the neighbouring ones
+			for(std::int64_t dx = -1; dx <= 1; ++dx) {
+				for(std::int64_t dy = -1; dy <= 1; ++dy) {
+					for(std::int64_t dz = -1; dz <= 1; ++dz) {
+						const std::uint64_t key = cellKey(x + dx, y + dy, z + dz);
+
+						for(auto cell = std::lower_bound(_cells.begin(), _cells.end(), key, isBefore);
+							cell != _cells.end() && cell->first == key; ++cell) {
+							const unsigned other = cell->second;
+
+							// Bodies before this one are already kept or fused
+							if(other <= b || _fusedInto[other] != other)
+								continue;
+
+							const float ox = _anchorX[other] - _anchorX[b];
+							const float oy = _anchorY[other] - _anchorY[b];
+							const float oz = _anchorZ[other] - _anchorZ[b];
+
+							if(ox * ox + oy * oy + oz * oz > radius2)
+								continue;
+
+							_fusedInto[other] = b;
+							_group.push_back(other);
+						}
+					}
+				}
+			}
+		}
+
+		if(_group.size() > 1)
+			merge(frame);
+
+		const pb::bodyUID uid = stableUID(frame);
+
+		// The fused bodies are all after this one, moving it up does not overwrite them
+		if(kept != b)
+			frame.copyBody(frame, b, kept);
+
+		frame.uids[kept] = uid;
+		++kept;
+	}
+
+	_fusedBodies = frame.bodyCount - kept;
+	frame.bodyCount = kept;
+
+	// Look the UIDs up by body UID in the next frame
+	std::sort(_currentUIDs.begin(), _currentUIDs.end());
+	std::swap(_previousUIDs, _currentUIDs);
+}
+
+bool BodyFusion::anchor(const Frame &frame, const size_t &body) {
+	const size_t neck = body * Frame::jointCount + neckJoint;
+	const size_t torso = body * Frame::jointCount + torsoJoint;
+
+	const float neckWeight = frame.positionConfidence[neck];
+	const float torsoWeight = frame.positionConfidence[torso];
+	const float weight = neckWeight + torsoWeight;
+
+	if(weight <= 0)
+		return false;
+
+	_anchorX[body] = (frame.positionX[neck] * neckWeight + frame.positionX[torso] * torsoWeight) / weight;
+	_anchorY[body] = (frame.positionY[neck] * neckWeight + frame.positionY[torso] * torsoWeight) / weight;
+	_anchorZ[body] = (frame.positionZ[neck] * neckWeight + frame.positionZ[torso] * torsoWeight) / weight;
+	return true;
+}
+
+std::uint64_t BodyFusion::cellKey(const std::int64_t &x, const std::int64_t &y, const std::int64_t &z) {
+	// Coordinates wrap around past 2^20 cells from the origin. Wrapped cells
+	// only give more bodies to compare, distances are still checked.
+	const std::uint64_t mask = (std::uint64_t(1) << cellBits) - 1;
+	const std::int64_t offset = std::int64_t(1) << (cellBits - 1);
+
+	return (std::uint64_t(x + offset) & mask) << (cellBits * 2) |
+		   (std::uint64_t(y + offset) & mask) << cellBits |
+		   (std::uint64_t(z + offset) & mask);
+}
+
+void BodyFusion::merge(Frame &frame) {
+	const size_t keptBody = _group.front() * Frame::jointCount;
+
+	for(size_t j = 0; j < Frame::jointCount; ++j) {
+		const size_t kept = keptBody + j;
+
+		float px = 0, py = 0, pz = 0, positionWeight = 0, positionConfidence = 0;
+		float qx = 0, qy = 0, qz = 0, qw = 0, orientationWeight = 0, orientationConfidence = 0;
+
+		for(const unsigned &body: _group) {
+			const size_t i = body * Frame::jointCount + j;
+
+			const float pc = frame.positionConfidence[i];
+			px += frame.positionX[i] * pc;
+			py += frame.positionY[i] * pc;
+			pz += frame.positionZ[i] * pc;
+			positionWeight += pc;
+			positionConfidence = std::max(positionConfidence, pc);
+
+			// q and -q are the same orientation, align them on the kept body before averaging
+			const float dot = frame.orientationX[i] * frame.orientationX[kept] +
+							  frame.orientationY[i] * frame.orientationY[kept] +
+							  frame.orientationZ[i] * frame.orientationZ[kept] +
+							  frame.orientationW[i] * frame.orientationW[kept];
+
+			const float oc = frame.orientationConfidence[i];
+			const float ow = dot < 0 ? -oc : oc;
+			qx += frame.orientationX[i] * ow;
+			qy += frame.orientationY[i] * ow;
+			qz += frame.orientationZ[i] * ow;
+			qw += frame.orientationW[i] * ow;
+			orientationWeight += oc;
+			orientationConfidence = std::max(orientationConfidence, oc);
+		}
+
+		// Joints no body is confident about are left as the kept body has them
+		if(positionWeight > 0) {
+			frame.positionX[kept] = px / positionWeight;
+			frame.positionY[kept] = py / positionWeight;
+			frame.positionZ[kept] = pz / positionWeight;
+			frame.positionConfidence[kept] = positionConfidence;
+		}
+
+		const float norm = std::sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+
+		if(orientationWeight > 0 && norm > 0) {
+			frame.orientationX[kept] = qx / norm;
+			frame.orientationY[kept] = qy / norm;
+			frame.orientationZ[kept] = qz / norm;
+			frame.orientationW[kept] = qw / norm;
+			frame.orientationConfidence[kept] = orientationConfidence;
+		}
+	}
+}
+
+pb::bodyUID BodyFusion::stableUID(const Frame &frame) {
+	const auto isGiven = [this] (const pb::bodyUID &uid) {
+		return std::binary_search(_givenUIDs.begin(), _givenUIDs.end(), uid);
+	};
+
+	const auto isBefore = [] (const std::pair<pb::bodyUID, pb::bodyUID> &entry, const pb::bodyUID &uid) {
+		return entry.first < uid;
+	};
+
+	// Prefer the UID one of the bodies had in the previous frame, then the
+	// UID of one of the bodies, as long as no other body of the frame has it
+	pb::bodyUID uid = 0;
+	bool found = false;
+
+	for(const unsigned &body: _group) {
+		auto entry = std::lower_bound(_previousUIDs.begin(), _previousUIDs.end(), frame.uids[body], isBefore);
+
+		if(entry != _previousUIDs.end() && entry->first == frame.uids[body] && !isGiven(entry->second)) {
+			uid = entry->second;
+			found = true;
+			break;
+		}
+	}
+
+	for(auto body = _group.begin(); !found && body != _group.end(); ++body) {
+		if(!isGiven(frame.uids[*body])) {
+			uid = frame.uids[*body];
+			found = true;
+		}
+	}
+
+	// All taken, make up a UID no body of the frame has. It is kept in the
+	// next frames like any other.
+	while(!found) {
+		uid = _nextUID--;
+		found = !isGiven(uid) && !std::binary_search(_frameUIDs.begin(), _frameUIDs.end(), uid);
+	}
+
+	for(const unsigned &body: _group) {
+		_currentUIDs.emplace_back(frame.uids[body], uid);
+	}
+
+	_givenUIDs.insert(std::upper_bound(_givenUIDs.begin(), _givenUIDs.end(), uid), uid);
+	return uid;
+}
@@ -0,0 +1,107 @@
+//
+//  BodyFusion.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef BodyFusion_hpp
+#define BodyFusion_hpp
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Fuses the bodies of a frame closer to each other than a radius, to merge
+/// the duplicates of overlapping sensors.
+///
+/// Frames do not tell which sensor saw a body, so any two bodies within the
+/// radius are fused, two people standing that close included. The radius
+/// should stay below the distance between two people.
+///
+/// Each body is anchored on its neck and torso joints. Anchors are binned in
+/// a grid of cells as large as the fusion radius, so a body is only compared
+/// with the bodies of the neighbouring cells. Bodies whose anchors lie within
+/// the radius of a first one are fused into it: each joint is averaged,
+/// weighted by the confidences of the bodies. A fused body keeps the UID it
+/// had in the previous frame for as long as one of its bodies is seen, so its
+/// slot stays the same. No two bodies of a frame get the same UID. Fusion
+/// must happen before the slots are assigned. Receive thread only.
+class BodyFusion {
+public:
+
+	/// Sets the distance under which two bodies are the same, 0 to disable the fusion
+	inline void setRadius(const float &radius) {
+		_radius = radius;
+	}
+
+	inline float radius() const {
+		return _radius;
+	}
+
+	/// Number of bodies removed from the last frame by fusing them
+	inline size_t fusedBodies() const {
+		return _fusedBodies;
+	}
+
+	/// Fuses the duplicated bodies of the frame, keeping the order of the remaining ones
+	void fuse(Frame &frame);
+
+private:
+
+	float _radius = 0;
+
+	size_t _fusedBodies = 0;
+
+	/// Anchor of each body, its neck and torso weighted by their confidences
+	std::vector<float> _anchorX;
+	std::vector<float> _anchorY;
+	std::vector<float> _anchorZ;
+
+	/// Tells if each body has an anchor, and can be fused
+	std::vector<bool> _anchored;
+
+	/// Grid cell key and index of each anchored body, sorted by key
+	std::vector<std::pair<std::uint64_t, unsigned>> _cells;
+
+	/// Index of the body each body is fused into, itself if it is kept
+	std::vector<unsigned> _fusedInto;
+
+	/// Bodies fused together, the kept one first
+	std::vector<unsigned> _group;
+
+	/// UID given to each body UID by the fusion of the previous frame, and of the current one
+	std::vector<std::pair<pb::bodyUID, pb::bodyUID>> _previousUIDs;
+	std::vector<std::pair<pb::bodyUID, pb::bodyUID>> _currentUIDs;
+
+	/// UIDs given to the bodies of the current frame, sorted
+	std::vector<pb::bodyUID> _givenUIDs;
+
+	/// UIDs of the bodies of the current frame, before fusion, sorted
+	std::vector<pb::bodyUID> _frameUIDs;
+
+	/// Next UID to try when all the UIDs of a fused body are taken. Counts
+	/// down from the top of the range, away from the UIDs of the masters.
+	pb::bodyUID _nextUID = std::numeric_limits<pb::bodyUID>::max();
+
+	/// Sizes the storage for the given number of bodies
+	void resize(const size_t &capacity);
+
+	/// Computes the anchor of the body. Returns false if the body has no confident neck or torso.
+	bool anchor(const Frame &frame, const size_t &body);
+
+	/// Key of the grid cell at the given cell coordinates
+	static std::uint64_t cellKey(const std::int64_t &x, const std::int64_t &y, const std::int64_t &z);
+
+	/// Averages the joints of the bodies of `_group` in the first one
+	void merge(Frame &frame);
+
+	/// Gives the fused body of `_group` a UID, stable from one frame to the
+	/// next, and not given to another body of the frame
+	pb::bodyUID stableUID(const Frame &frame);
+};
+
+#endif /* BodyFusion_hpp */
@@ -0,0 +1,70 @@
+//
+//  BodyHold.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+
+#include "BodyHold.hpp"
+
+void BodyHold::reset() {
+	std::fill(_holding.begin(), _holding.end(), false);
+}
+
+void BodyHold::resize(const size_t &slotCount) {
+	_poses.reserve(slotCount);
+	_holding.assign(slotCount, false);
+	_lastSeen.assign(slotCount, 0.);
+	_seenIn.assign(slotCount, 0);
+}
+
+void BodyHold::apply(Frame &frame) {
+	if(frame.capacity() != _poses.capacity())
+		resize(frame.capacity());
+
+	++_applied;
+
+	// Record the bodies present
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		const unsigned slot = frame.slots[b];
+
+		_poses.copyBody(frame, b, slot);
+		_holding[slot] = true;
+		_lastSeen[slot] = frame.timestamp;
+		_seenIn[slot] = _applied;
+	}
+
+	// Rebuild the frame in slot order, adding back the missing bodies, so
+	// the bodies keep their place in the output
+	frame.bodyCount = 0;
+
+	for(size_t slot = 0; slot < _holding.size(); ++slot) {
+		if(!_holding[slot])
+			continue;
+
+		const double missing = frame.timestamp - _lastSeen[slot];
+		const bool present = _seenIn[slot] == _applied;
+
+		if(!present && missing > _gracePeriod) {
+			_holding[slot] = false;
+			continue;
+		}
+
+		const size_t b = frame.bodyCount++;
+		frame.copyBody(_poses, slot, b);
+
+		if(present || !_fade)
+			continue;
+
+		// Fade linearly over the grace period
+		const float weight = (float)(1. - missing / _gracePeriod);
+		const size_t b0 = b * Frame::jointCount;
+
+		for(size_t j = b0; j < b0 + Frame::jointCount; ++j) {
+			frame.positionConfidence[j] *= weight;
+			frame.orientationConfidence[j] *= weight;
+		}
+	}
+}
@@ -0,0 +1,68 @@
+//
+//  BodyHold.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef BodyHold_hpp
+#define BodyHold_hpp
+
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Keeps bodies lost by the tracking in the frames for a grace period.
+///
+/// The last pose of each body slot is recorded, and a body missing from a
+/// frame is added back with that pose until it has been missing for longer
+/// than the grace period. Its confidences can fade out over the period. A body
+/// coming back under the same UID gets its slot back from `BodySlots` and
+/// simply replaces its held pose. Bodies are output in slot order, so they
+/// keep their place. Held bodies must be added after the slots have been
+/// assigned. Receive thread only.
+class BodyHold {
+public:
+
+	/// Sets for how long, in seconds, a lost body is held, and if its confidences fade out meanwhile
+	inline void setGracePeriod(const double &gracePeriod, const bool &fade) {
+		_gracePeriod = gracePeriod;
+		_fade = fade;
+	}
+
+	inline double gracePeriod() const {
+		return _gracePeriod;
+	}
+
+	/// Forgets all the bodies
+	void reset();
+
+	/// Records the bodies of the frame, adds back the ones lost for less than the grace period, and sorts them by slot
+	void apply(Frame &frame);
+
+private:
+
+	double _gracePeriod = 0;
+
+	bool _fade = false;
+
+	/// Last pose of the body of each slot, at the body index equal to the slot
+	Frame _poses;
+
+	/// Tells if the slot holds a pose
+	std::vector<bool> _holding;
+
+	/// Last time each slot's body was seen
+	std::vector<double> _lastSeen;
+
+	/// Generation of the last frame each slot's body was in
+	std::vector<unsigned long> _seenIn;
+
+	/// Number of frames applied, to tell the bodies present in the current one
+	unsigned long _applied = 0;
+
+	/// Sizes the poses storage for the given number of slots and clears it
+	void resize(const size_t &slotCount);
+};
+
+#endif /* BodyHold_hpp */
@@ -0,0 +1,179 @@
+//
+//  BodySlots.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+#include "BodySlots.hpp"
+
+#include "Frame.hpp"
+
+void BodySlots::resize(const size_t &count) {
+	if(count == _owners.size())
+		return;
+
+	// Keep the table at most half full
+	size_t tableSize = 8;
+
+	while(tableSize < count * 2)
+		tableSize *= 2;
+
+	_table.resize(tableSize);
+	_owners.resize(count);
+	_taken.resize(count);
+	_lastSeen.resize(count);
+	_seenAt.resize(count);
+	_free.reserve(count);
+
+	reset();
+}
+
+void BodySlots::reset() {
+	for(Entry &entry: _table) {
+		entry.used = false;
+	}
+
+	std::fill(_taken.begin(), _taken.end(), false);
+
+	_free.clear();
+
+	for(size_t s = _owners.size(); s > 0; --s) {
+		_free.push_back((unsigned)s - 1);
+	}
+}
+
+void BodySlots::assign(Frame &frame) {
+	const unsigned unassigned = (unsigned)_owners.size();
+	const size_t tableSize = _table.size();
+
+	++_assignments;
+
+	// Bodies we already know keep their slot
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		size_t i = find(frame.uids[b]);
+
+		if(i == tableSize) {
+			frame.slots[b] = unassigned;
+			continue;
+		}
+
+		unsigned slot = _table[i].slot;
+
+		frame.slots[b] = slot;
+		_lastSeen[slot] = frame.timestamp;
+		_seenAt[slot] = _assignments;
+	}
+
+	// Free the slots of the bodies missing for too long
+	for(unsigned s = 0; s < unassigned; ++s) {
+		if(_taken[s] && _seenAt[s] != _assignments && frame.timestamp - _lastSeen[s] >= _timeout)
+			release(s);
+	}
+
+	// And give slots to the new ones
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		if(frame.slots[b] != unassigned)
+			continue;
+
+		unsigned slot = take(frame.uids[b]);
+
+		frame.slots[b] = slot;
+		_lastSeen[slot] = frame.timestamp;
+		_seenAt[slot] = _assignments;
+	}
+}
+
+// MARK: - Table
+
+size_t BodySlots::home(const pb::bodyUID &uid) const {
+	// Fibonacci hashing spreads sequential UIDs over the table
+	uint64_t hash = (uint64_t)std::hash<pb::bodyUID>()(uid) * 0x9E3779B97F4A7C15ull;
+	return (size_t)(hash >> 32) & (_table.size() - 1);
+}
+
+size_t BodySlots::find(const pb::bodyUID &uid) const {
+	const size_t mask = _table.size() - 1;
+
+	for(size_t i = home(uid); _table[i].used; i = (i + 1) & mask) {
+		if(_table[i].uid == uid)
+			return i;
+	}
+
+	return _table.size();
+}
+
+void BodySlots::insert(const pb::bodyUID &uid, const unsigned &slot) {
+	const size_t mask = _table.size() - 1;
+	size_t i = home(uid);
+
+	while(_table[i].used)
+		i = (i + 1) & mask;
+
+	_table[i].uid = uid;
+	_table[i].slot = slot;
+	_table[i].used = true;
+}
+
+void BodySlots::erase(const pb::bodyUID &uid) {
+	const size_t mask = _table.size() - 1;
+	size_t hole = find(uid);
+
+	if(hole == _table.size())
+		return;
+
+	// Shift back the entries following the hole that probed past it, so
+	// lookups never stop early on it
+	for(size_t i = (hole + 1) & mask; _table[i].used; i = (i + 1) & mask) {
+		size_t h = home(_table[i].uid);
+
+		bool canMove = hole <= i ? (h <= hole || h > i) : (h <= hole && h > i);
+
+		if(canMove) {
+			_table[hole] = _table[i];
+			hole = i;
+		}
+	}
+
+	_table[hole].used = false;
+}
+
+// MARK: - Slots
+
+unsigned BodySlots::take(const pb::bodyUID &uid) {
+	// If every slot is kept for a missing body, reuse the one missing for the longest time
+	if(_free.empty()) {
+		unsigned oldest = (unsigned)_owners.size();
+
+		for(unsigned s = 0; s < _owners.size(); ++s) {
+			if(_seenAt[s] == _assignments)
+				continue;
+
+			if(oldest == _owners.size() || _lastSeen[s] < _lastSeen[oldest])
+				oldest = s;
+		}
+
+		release(oldest);
+	}
+
+	unsigned slot = _free.back();
+	_free.pop_back();
+
+	_owners[slot] = uid;
+	_taken[slot] = true;
+	insert(uid, slot);
+
+	return slot;
+}
+
+void BodySlots::release(const unsigned &slot) {
+	erase(_owners[slot]);
+	_taken[slot] = false;
+
+	// Keep the lowest slots on top
+	_free.insert(std::upper_bound(_free.begin(), _free.end(), slot, std::greater<unsigned>()), slot);
+}
@@ -0,0 +1,93 @@
+//
+//  BodySlots.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef BodySlots_hpp
+#define BodySlots_hpp
+
+#include <vector>
+
+#include <pb-common/common.hpp>
+
+struct Frame;
+
+/// Gives each tracked body a slot, used both as its output slot and as its
+/// body index in the channel names.
+///
+/// A body keeps its slot while it is tracked, and for `timeout` seconds after
+/// it was last seen, so a body coming back quickly gets its slot back. Slots
+/// are found through a flat, open-addressed UID table: memory only depends on
+/// the number of slots, never on how many bodies were seen. Receive thread only.
+class BodySlots {
+public:
+
+	/// Sets the number of slots. All the slots are freed if it changes
+	void resize(const size_t &count);
+
+	/// Sets for how long, in seconds, the slot of a missing body is kept for it
+	inline void setTimeout(const double &timeout) {
+		_timeout = timeout;
+	}
+
+	/// Frees all the slots. Bodies are numbered from 0 again
+	void reset();
+
+	/// Assigns a slot to every body of the frame, and writes them in `frame.slots`
+	void assign(Frame &frame);
+
+private:
+
+	struct Entry {
+		pb::bodyUID uid;
+		unsigned slot;
+		bool used = false;
+	};
+
+	/// UID to slot table, linearly probed. Its size is a power of two
+	std::vector<Entry> _table;
+
+	/// Body owning each slot
+	std::vector<pb::bodyUID> _owners;
+
+	/// Tells if each slot has an owner
+	std::vector<bool> _taken;
+
+	/// Last time each slot's owner was seen
+	std::vector<double> _lastSeen;
+
+	/// Last assignment each slot's owner was part of
+	std::vector<unsigned long> _seenAt;
+
+	/// Free slots, lowest on top
+	std::vector<unsigned> _free;
+
+	/// Number of assignments made
+	unsigned long _assignments = 0;
+
+	double _timeout = 0;
+
+	// MARK: - Table
+
+	/// Home position of the UID in the table
+	size_t home(const pb::bodyUID &uid) const;
+
+	/// Position of the UID in the table, or the table size if it isn't there
+	size_t find(const pb::bodyUID &uid) const;
+
+	void insert(const pb::bodyUID &uid, const unsigned &slot);
+
+	void erase(const pb::bodyUID &uid);
+
+	// MARK: - Slots
+
+	/// Gives a slot to the given body
+	unsigned take(const pb::bodyUID &uid);
+
+	/// Frees the given slot
+	void release(const unsigned &slot);
+};
+
+#endif /* BodySlots_hpp */
@@ -5,18 +5,45 @@
 //  Created by Valentin Dufois on 2019-11-19.
 //
 
-#include <pb-common/Structs/Body.hpp>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
 
 #include "Core.hpp"
 
+/// Name of each joint, by index
+static constexpr const char * jointNames[Frame::jointCount] = {
+	"head", "neck",
+	"leftShoulder", "rightShoulder",
+	"leftElbow", "rightElbow",
+	"leftHand", "rightHand",
+	"torso",
+	"leftHip", "rightHip",
+	"leftKnee", "rightKnee",
+	"leftFoot", "rightFoot"
+};
+
+/// Name of the channels of each output, in output order
+static constexpr const char * positionChannels[] = {"tx", "ty", "tz"};
+static constexpr const char * orientationChannels[] = {"rx", "ry", "rz"};
+static constexpr const char * velocityChannels[] = {"vx", "vy", "vz"};
+static constexpr const char * accelerationChannels[] = {"ax", "ay", "az"};
+static constexpr const char * confidenceChannels[] = {"tconf", "rconf"};
+
 Core::Core() {
-	_receiver.open();
-	_receiver.addObserver(this);
+	_frames.reserve(_pipeline.poolSize());
+	_samples.reserve(_pipeline.poolSize());
+	_released.reserve(_pipeline.poolSize());
+	_emptyFrame.reserve(0);
+
+	_hub = ReceiverHub::shared();
+	_hub->addObserver(this);
 }
 
 Core::~Core()
 {
-	_receiver.close();
+	// The hub closes the receiver once the last op leaves it
+	_hub->removeObserver(this);
 }
 
 
@@ -27,9 +54,10 @@ Core::getGeneralInfo(CHOP_GeneralInfo* ginfo, const OP_Inputs* inputs, void* res
 {
 	// Set our parameters
 
-	// This will cause the node to cook every frame
+	// Cook every frame, but only while something downstream uses us. Ops
+	// nobody cooks go idle on the receive thread.
 	ginfo->cookEveryFrameIfAsked = true;
-	ginfo->cookEveryFrame = true;
+	ginfo->cookEveryFrame = false;
 
 	// Note: To disable timeslicing you'll need to turn this off, as well as ensure that
 	// getOutputInfo() returns true, and likely also set the info->numSamples to how many
@@ -41,30 +69,120 @@ Core::getGeneralInfo(CHOP_GeneralInfo* ginfo, const OP_Inputs* inputs, void* res
 bool
 Core::getOutputInfo(CHOP_OutputInfo* info, const OP_Inputs* inputs, void* reserved1)
 {
-	// Since we are outputting a timeslice, the system will dictate
-	// the numSamples and startIndex of the CHOP data
+	// We are not timesliced, we give the numSamples and startIndex of the
+	// CHOP data ourselves once we know which frames are output
 	info->numSamples = 1;
 	info->startIndex = 0;
 
-	// We are about to execute, get a copy of the bodies
-	// Did we receive any bodies from the network ?
+	// We are cooked, wake the receive side up
+	_idleFrames.store(inputs->getParInt("Pbidleframes"), std::memory_order_relaxed);
+	_uncookedFrames.store(0, std::memory_order_relaxed);
+
+	_timeslice = inputs->getParInt("Pbtimeslice");
+	_resampler.setRate(inputs->getParDouble("Pbresamplerate"));
+	_jitter.setDelay(inputs->getParDouble("Pbjitterdelay") / 1000.);
+
+	const bool resample = _resampler.rate() > 0;
+	const bool buffered = _jitter.delay() > 0;
+
+	// Update the pipeline behaviour. Outputting every frame, resampling
+	// them or buffering them, needs them all.
+	FramePipeline::Policy policy = (FramePipeline::Policy)inputs->getParInt("Pbqueuepolicy");
+
+	if((_timeslice || resample || buffered) && policy == FramePipeline::latest)
+		policy = FramePipeline::drainAll;
+
+	_pipeline.setPolicy(policy);
+	_pipeline.setDepth(inputs->getParInt("Pbqueuedepth"));
+	_maxBodies.store(inputs->getParInt("Pbmaxbodies"), std::memory_order_relaxed);
+	_slotTimeout.store(inputs->getParDouble("Pbslottimeout"), std::memory_order_relaxed);
+	_holdTime.store(inputs->getParDouble("Pbholdtime"), std::memory_order_relaxed);
+	_holdFade.store(inputs->getParInt("Pbholdfade"), std::memory_order_relaxed);
+	_fusionRadius.store(inputs->getParDouble("Pbfusionradius"), std::memory_order_relaxed);
+
+	// Smoothing is applied on the receive thread
+	_smoothing.store(inputs->getParInt("Pbsmoothing"), std::memory_order_relaxed);
+	_minCutoff.store(inputs->getParDouble("Pbmincutoff"), std::memory_order_relaxed);
+	_beta.store(inputs->getParDouble("Pbbeta"), std::memory_order_relaxed);
+	_derivativeCutoff.store(inputs->getParDouble("Pbdcutoff"), std::memory_order_relaxed);
+	_processNoise.store(inputs->getParDouble("Pbprocessnoise"), std::memory_order_relaxed);
+	_measurementNoise.store(inputs->getParDouble("Pbmeasurementnoise"), std::memory_order_relaxed);
+	_coastTime.store(inputs->getParDouble("Pbcoasttime"), std::memory_order_relaxed);
+
+	// We are about to execute, get the frames received since the last cook.
+	// If nothing new was published, we keep the ones we already hold.
+	size_t received = _pipeline.consume(_frames);
+	const double now = Frame::now();
+
+	// How long the newest frame waited for us
+	if(received > 0)
+		_queueTime = now - _frames.back()->published;
+
+	// With the jitter buffer, the frames received go through it first, and we
+	// get the ones due instead
+	if(buffered)
+		received = _jitter.process(_frames, received, now, _released);
+
+	std::vector<Frame *> &frames = heldFrames();
+	Frame &frame = currentFrame();
+
+	_frameAge = frame.generation == 0 ? 0 : now - frame.timestamp;
+
+	// Set the outputs
+	_outputPositions = inputs->getParInt("Pboutputpositions");
+	_outputOrientations = inputs->getParInt("Pboutputorientations");
+	_outputConfidences = inputs->getParInt("Pboutputconfs");
+	_outputVelocities = inputs->getParInt("Pboutputvelocities");
+	_outputAccelerations = inputs->getParInt("Pboutputaccelerations");
+	_bodySamples = inputs->getParInt("Pbbodysamples");
+
+	// Samples in time need a stable channel layout
+	_fixedSlots = (!_bodySamples && (_timeslice || resample)) || inputs->getParInt("Pbfixedslots");
+
+	// Select the frames to output as samples, oldest first. Without
+	// timeslicing, or without new frames, only the latest one is output.
+	// When bodies are the samples, only the latest frame is output.
+	_samples.clear();
+
+	if(resample && !_bodySamples) {
+		_resampler.process(frames, received, _samples);
+		info->sampleRate = (float)_resampler.rate();
+	} else if(_timeslice && !_bodySamples && received > 1) {
+		// All the samples must share the same layout
+		for(Frame * sample: frames) {
+			if(sample->capacity() == frame.capacity())
+				_samples.push_back(sample);
+		}
+	}
 
-	_receiver.arena()->lock();
+	if(_samples.empty())
+		_samples.push_back(&frame);
 
-	std::vector<pb::Body *> bodies = _receiver.arena()->getSubset();
-	
-	for(pb::Body * body: bodies) {
-		_bodies.push_back(new pb::Body(*body));
+	// Predict the samples ahead, to hide the stream latency
+	_extrapolator.setHorizon(inputs->getParDouble("Pbextrapolation") / 1000.);
+
+	if(_extrapolator.horizon() > 0) {
+		_extrapolator.process(_samples);
 	}
 
-	_receiver.arena()->unlock();
+	const unsigned outputs = getOutputs();
 
-	// Set the number of channels
-	_outputPositions = inputs->getParInt("Pboutputpositions");
-	_outputOrientations = inputs->getParInt("Pboutputorientations");
-	_outputConfidences = inputs->getParInt("Pboutputconfs");
+	info->numSamples = (int32_t)(_samples.size() == 1 ? _samples.front()->sampleCount(outputs) : _samples.size());
+
+	// Frames follow each other on the timeline, each cook starting where the
+	// previous one ended. Bodies as samples are not in time.
+	if(!_bodySamples) {
+		info->startIndex = _startIndex;
+		_startIndex += (uint32_t)info->numSamples;
+	}
+
+	// Let the receive thread pack the next frames for us
+	_prepackOutputs.store(inputs->getParInt("Pbprepack") ? (int)outputs : -1, std::memory_order_relaxed);
 
-	info->numChannels = 1 + (int)_bodies.size() * getChannelCountByBody();
+	info->numChannels = (int)frame.channelCount(outputs);
+
+	if(!areChannelNamesValid(frame))
+		updateChannelNames(frame);
 
 	return true;
 }
@@ -72,62 +190,47 @@ Core::getOutputInfo(CHOP_OutputInfo* info, const OP_Inputs* inputs, void* reserv
 void
 Core::getChannelName(int32_t index, OP_String *name, const OP_Inputs* inputs, void* reserved1)
 {
-	// First channel is the number of bodies
-	if(index == 0) {
-		name->setString("body_count");
-		return;
-	}
-
-	int bodyChannels = getChannelCountByBody();
-	int jointChannels = getChannelCountByJoint();
-
-	int32_t bodyIndex = floor((index - 1) / bodyChannels);
-	int32_t jointIndex = ((index - 1) % bodyChannels) / jointChannels;
-	int32_t channelIndex = ((index - 1) % bodyChannels) % jointChannels;
-
-	std::string channelName = "body" + std::to_string(getBodyIndex(_bodies[bodyIndex]->uid)) + "/" + getJointName(jointIndex) + ":" + getJointChannelName(channelIndex);
-
-	 name->setString(channelName.c_str());
+	if(index < (int32_t)_channelNames.size())
+		name->setString(_channelNames[index].c_str());
 }
 
 void
 Core::execute(CHOP_Output* output, const OP_Inputs* inputs, void* reserved)
 {
-	// First, set the body count
-	output->channels[0][0] = _bodies.size();
-	unsigned int currChannel = 1;
-
-	for(pb::Body * body: _bodies) {
-		for(pb::Joint &joint: body->skeleton()->joints) {
-			bool posConf = joint.positionConfidence > 0 && joint.positionConfidence <= 1.0;
-			bool orConf = joint.orientationConfidence > 0 && joint.orientationConfidence <= 1.0;
-
-			if(_outputPositions) {
-				output->channels[currChannel + 0][0] = posConf ? joint.position.x : 0;
-				output->channels[currChannel + 1][0] = posConf ? joint.position.y : 0;
-				output->channels[currChannel + 2][0] = posConf ? -joint.position.z : 0;
-				currChannel += 3;
-			}
+	const Frame &frame = currentFrame();
+	const unsigned outputs = getOutputs();
+
+	// Pack the frames ourselves if the receive thread did not, or did it
+	// with other outputs than the current ones. Packing is kept with the
+	// frame, so when no new frame arrived since the last cook, there is
+	// nothing to redo.
+	for(Frame * sample: _samples) {
+		if(sample->packedOutputs != (int)outputs)
+			packFrame(*sample, outputs);
+	}
 
-			if(_outputOrientations) {
-				output->channels[currChannel + 0][0] = orConf ? joint.orientation.x : 0;
-				output->channels[currChannel + 1][0] = orConf ? joint.orientation.y : 0;
-				output->channels[currChannel + 2][0] = orConf ? joint.orientation.z : 0;
-				currChannel += 3;
-			}
+	if(frame.generation == _cookedGeneration)
+		++_staleCooks;
 
-			if(_outputConfidences) {
-				output->channels[currChannel + 0][0] = joint.positionConfidence;
-				output->channels[currChannel + 1][0] = joint.orientationConfidence;
-				currChannel += 2;
-			}
+	_cookedGeneration = frame.generation;
+
+	// A single frame is already laid out channel after channel
+	if(_samples.size() == 1) {
+		const float * values = _samples.front()->packed.data();
+
+		for(int32_t c = 0; c < output->numChannels; ++c) {
+			std::copy_n(values + c * output->numSamples, output->numSamples, output->channels[c]);
 		}
+
+		return;
 	}
 
-	for(pb::Body * body: _bodies) {
-		delete body;
+	// One sample per frame
+	for(int32_t c = 0; c < output->numChannels; ++c) {
+		for(int32_t s = 0; s < output->numSamples; ++s) {
+			output->channels[c][s] = _samples[s]->packed[c];
+		}
 	}
-	_bodies.clear();
 }
 
 void
@@ -158,6 +261,51 @@ Core::setupParameters(OP_ParameterManager* manager, void *reserved1)
 	res = manager->appendToggle(confsToggle);
 	assert(res == OP_ParAppendResult::Success);
 
+	OP_NumericParameter velocitiesToggle;
+	velocitiesToggle.name = "Pboutputvelocities";
+	velocitiesToggle.label = "Velocities";
+
+	res = manager->appendToggle(velocitiesToggle);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter accelerationsToggle;
+	accelerationsToggle.name = "Pboutputaccelerations";
+	accelerationsToggle.label = "Accelerations";
+
+	res = manager->appendToggle(accelerationsToggle);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Output layout
+	OP_NumericParameter fixedSlotsToggle;
+	fixedSlotsToggle.name = "Pbfixedslots";
+	fixedSlotsToggle.label = "Fixed body slots";
+
+	res = manager->appendToggle(fixedSlotsToggle);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter bodySamplesToggle;
+	bodySamplesToggle.name = "Pbbodysamples";
+	bodySamplesToggle.label = "Bodies as samples";
+
+	res = manager->appendToggle(bodySamplesToggle);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter timesliceToggle;
+	timesliceToggle.name = "Pbtimeslice";
+	timesliceToggle.label = "Output all frames";
+
+	res = manager->appendToggle(timesliceToggle);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter resampleRate;
+	resampleRate.name = "Pbresamplerate";
+	resampleRate.label = "Resample rate";
+	resampleRate.maxSliders[0] = 240;
+	resampleRate.clampMins[0] = true;
+
+	res = manager->appendFloat(resampleRate);
+	assert(res == OP_ParAppendResult::Success);
+
 	// Body index reset
 	OP_NumericParameter resetIndex;
 	resetIndex.name = "Pbresetindexes";
@@ -165,114 +313,528 @@ Core::setupParameters(OP_ParameterManager* manager, void *reserved1)
 
 	res = manager->appendPulse(resetIndex);
 	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter slotTimeout;
+	slotTimeout.name = "Pbslottimeout";
+	slotTimeout.label = "Index timeout";
+	slotTimeout.defaultValues[0] = 2;
+	slotTimeout.maxSliders[0] = 10;
+	slotTimeout.clampMins[0] = true;
+
+	res = manager->appendFloat(slotTimeout);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Lost bodies
+	OP_NumericParameter holdTime;
+	holdTime.name = "Pbholdtime";
+	holdTime.label = "Hold lost bodies";
+	holdTime.maxSliders[0] = 2;
+	holdTime.clampMins[0] = true;
+
+	res = manager->appendFloat(holdTime);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter holdFade;
+	holdFade.name = "Pbholdfade";
+	holdFade.label = "Fade held bodies";
+
+	res = manager->appendToggle(holdFade);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Frame queue
+	OP_StringParameter queuePolicy;
+	queuePolicy.name = "Pbqueuepolicy";
+	queuePolicy.label = "Frame queue";
+	queuePolicy.defaultValue = "Latest";
+
+	const char * queuePolicyNames[] = {"Latest", "Drainall", "Bounded"};
+	const char * queuePolicyLabels[] = {"Latest only", "Drain all", "Bounded"};
+
+	res = manager->appendMenu(queuePolicy, 3, queuePolicyNames, queuePolicyLabels);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter queueDepth;
+	queueDepth.name = "Pbqueuedepth";
+	queueDepth.label = "Frame queue depth";
+	queueDepth.defaultValues[0] = 4;
+	queueDepth.minValues[0] = 1;
+	queueDepth.maxValues[0] = 31;
+	queueDepth.maxSliders[0] = 31;
+	queueDepth.clampMins[0] = true;
+	queueDepth.clampMaxes[0] = true;
+
+	res = manager->appendInt(queueDepth);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Jitter buffer
+	OP_NumericParameter jitterDelay;
+	jitterDelay.name = "Pbjitterdelay";
+	jitterDelay.label = "Jitter buffer delay (ms)";
+	jitterDelay.minValues[0] = 0;
+	jitterDelay.maxValues[0] = 1000;
+	jitterDelay.maxSliders[0] = 200;
+	jitterDelay.clampMins[0] = true;
+	jitterDelay.clampMaxes[0] = true;
+
+	res = manager->appendFloat(jitterDelay);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Extrapolation
+	OP_NumericParameter extrapolation;
+	extrapolation.name = "Pbextrapolation";
+	extrapolation.label = "Extrapolation (ms)";
+	extrapolation.minValues[0] = 0;
+	extrapolation.maxValues[0] = 500;
+	extrapolation.maxSliders[0] = 100;
+	extrapolation.clampMins[0] = true;
+	extrapolation.clampMaxes[0] = true;
+
+	res = manager->appendFloat(extrapolation);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Smoothing
+	OP_StringParameter smoothing;
+	smoothing.name = "Pbsmoothing";
+	smoothing.label = "Smoothing";
+	smoothing.defaultValue = "Off";
+
+	const char * smoothingNames[] = {"Off", "Oneeuro", "Kalman"};
+	const char * smoothingLabels[] = {"Off", "One Euro", "Kalman"};
+
+	res = manager->appendMenu(smoothing, 3, smoothingNames, smoothingLabels);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter minCutoff;
+	minCutoff.name = "Pbmincutoff";
+	minCutoff.label = "Min cutoff (Hz)";
+	minCutoff.defaultValues[0] = 1;
+	minCutoff.minValues[0] = .001;
+	minCutoff.maxSliders[0] = 10;
+	minCutoff.clampMins[0] = true;
+
+	res = manager->appendFloat(minCutoff);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter beta;
+	beta.name = "Pbbeta";
+	beta.label = "Speed coefficient";
+	beta.defaultValues[0] = .5;
+	beta.maxSliders[0] = 5;
+	beta.clampMins[0] = true;
+
+	res = manager->appendFloat(beta);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter derivativeCutoff;
+	derivativeCutoff.name = "Pbdcutoff";
+	derivativeCutoff.label = "Speed cutoff (Hz)";
+	derivativeCutoff.defaultValues[0] = 1;
+	derivativeCutoff.minValues[0] = .001;
+	derivativeCutoff.maxSliders[0] = 10;
+	derivativeCutoff.clampMins[0] = true;
+
+	res = manager->appendFloat(derivativeCutoff);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter processNoise;
+	processNoise.name = "Pbprocessnoise";
+	processNoise.label = "Process noise";
+	processNoise.defaultValues[0] = 3;
+	processNoise.maxSliders[0] = 100;
+	processNoise.clampMins[0] = true;
+
+	res = manager->appendFloat(processNoise);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter measurementNoise;
+	measurementNoise.name = "Pbmeasurementnoise";
+	measurementNoise.label = "Measurement noise (m)";
+	measurementNoise.defaultValues[0] = .02;
+	measurementNoise.minValues[0] = .0001;
+	measurementNoise.maxSliders[0] = .2;
+	measurementNoise.clampMins[0] = true;
+
+	res = manager->appendFloat(measurementNoise);
+	assert(res == OP_ParAppendResult::Success);
+
+	OP_NumericParameter coastTime;
+	coastTime.name = "Pbcoasttime";
+	coastTime.label = "Coast time";
+	coastTime.defaultValues[0] = .5;
+	coastTime.maxSliders[0] = 2;
+	coastTime.clampMins[0] = true;
+
+	res = manager->appendFloat(coastTime);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Fusion
+	OP_NumericParameter fusionRadius;
+	fusionRadius.name = "Pbfusionradius";
+	fusionRadius.label = "Merge bodies closer than (m)";
+	fusionRadius.defaultValues[0] = 0;
+	fusionRadius.minValues[0] = 0;
+	fusionRadius.maxSliders[0] = 1;
+	fusionRadius.clampMins[0] = true;
+
+	res = manager->appendFloat(fusionRadius);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Body pool
+	OP_NumericParameter maxBodies;
+	maxBodies.name = "Pbmaxbodies";
+	maxBodies.label = "Max bodies";
+	maxBodies.defaultValues[0] = 16;
+	maxBodies.minValues[0] = 1;
+	maxBodies.maxValues[0] = ReceiverHub::maxBodies;
+	maxBodies.maxSliders[0] = 32;
+	maxBodies.clampMins[0] = true;
+	maxBodies.clampMaxes[0] = true;
+
+	res = manager->appendInt(maxBodies);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Idle
+	OP_NumericParameter idleFrames;
+	idleFrames.name = "Pbidleframes";
+	idleFrames.label = "Idle after frames";
+	idleFrames.defaultValues[0] = 30;
+	idleFrames.minValues[0] = 0;
+	idleFrames.maxSliders[0] = 120;
+	idleFrames.clampMins[0] = true;
+
+	res = manager->appendInt(idleFrames);
+	assert(res == OP_ParAppendResult::Success);
+
+	// Receive-side packing
+	OP_NumericParameter prepackToggle;
+	prepackToggle.name = "Pbprepack";
+	prepackToggle.label = "Pack on receive";
+	prepackToggle.defaultValues[0] = 1;
+
+	res = manager->appendToggle(prepackToggle);
+	assert(res == OP_ParAppendResult::Success);
 }
 
 void 
 Core::pulsePressed(const char* name, void* reserved1)
 {
+	if(!strcmp(name, "Pbresetindexes")) {
+		_resetSlots.store(true, std::memory_order_relaxed);
+	}
+}
+
+int32_t Core::getNumInfoCHOPChans(void *reserved1) {
+	return 14;
+}
+
+void Core::getInfoCHOPChan(int32_t index, OP_InfoCHOPChan *chan, void *reserved1) {
+	switch(index) {
+		case 0:
+			chan->name->setString("dropped_frames");
+			chan->value = (float)_pipeline.droppedFrames();
+			break;
+		case 1:
+			chan->name->setString("body_allocations");
+			chan->value = (float)_bodyAllocations.load(std::memory_order_relaxed);
+			break;
+		case 2:
+			chan->name->setString("frame_generation");
+			chan->value = (float)_pipeline.generation();
+			break;
+		case 3:
+			chan->name->setString("stale_cooks");
+			chan->value = (float)_staleCooks;
+			break;
+		case 4:
+			chan->name->setString("pack_time_us");
+			chan->value = _packTime.load(std::memory_order_relaxed);
+			break;
+		case 5:
+			chan->name->setString("jitter_depth");
+			chan->value = (float)_jitter.depth();
+			break;
+		case 6:
+			chan->name->setString("jitter_late_frames");
+			chan->value = (float)_jitter.lateFrames();
+			break;
+		case 7:
+			chan->name->setString("jitter_early_frames");
+			chan->value = (float)_jitter.earlyFrames();
+			break;
+		case 8:
+			chan->name->setString("jitter_dropped_frames");
+			chan->value = (float)_jitter.droppedFrames();
+			break;
+		case 9:
+			chan->name->setString("frame_age_ms");
+			chan->value = (float)(_frameAge * 1000.);
+			break;
+		case 10:
+			chan->name->setString("queue_time_ms");
+			chan->value = (float)(_queueTime * 1000.);
+			break;
+		case 11:
+			chan->name->setString("transit_delay_ms");
+			chan->value = currentFrame().transitDelay * 1000.f;
+			break;
+		case 12:
+			chan->name->setString("receive_idle");
+			chan->value = isIdle() ? 1.f : 0.f;
+			break;
+		case 13:
+			chan->name->setString("fused_bodies");
+			chan->value = (float)_fusedBodies.load(std::memory_order_relaxed);
+			break;
+	}
 }
 
 void Core::getWarningString(OP_String * warning, void *reserved1) {
-	if(!_isConnected) {
+	if(!_hub->isConnected()) {
 		warning->setString("Looking for a Locator Master on the network...");
 	}
 }
 
-// MARK: - PBReceiverDelegate
+// MARK: - Receiver Hub Observer
 
+bool Core::isIdle() const {
+	const unsigned idleFrames = _idleFrames.load(std::memory_order_relaxed);
+	return idleFrames > 0 && _uncookedFrames.load(std::memory_order_relaxed) >= idleFrames;
+}
 
-void Core::receiverDidConnect(pb::PBReceiver *) {
-	_isConnected = true;
-};
+void Core::hubDidUpdate(ReceiverHub *, const Frame &snapshot) {
+	// Nobody cooked us for a while, skip the frame until we are cooked again
+	if(isIdle())
+		return;
+
+	_uncookedFrames.fetch_add(1, std::memory_order_relaxed);
 
-void Core::receiverDidUpdate(pb::PBReceiver *) {};
+	// Copy the snapshot in a free frame. The joints are laid out here, on
+	// the receive thread, so the cook thread never has to walk the bodies.
+	Frame * frame = acquireFrame();
 
-void Core::receiverDidClose(pb::PBReceiver *) {
-	_isConnected = false;
+	// Bodies past our maximum are ignored
+	frame->bodyCount = std::min(snapshot.bodyCount, frame->capacity());
+	frame->timestamp = snapshot.timestamp;
+
+	for(size_t b = 0; b < frame->bodyCount; ++b) {
+		frame->copyBody(snapshot, b, b);
+	}
+
+	publishFrame(frame);
 };
 
+void Core::hubDidClose(ReceiverHub *) {
+	// Publish an empty frame so we stop outputting stale bodies. The bodies
+	// of the next connection start with fresh smoothing and motion.
+	_hold.reset();
+	_oneEuro.reset();
+	_kalman.reset();
+	_motion.reset();
+	publishFrame(acquireFrame());
+
+	// Arrivals will resume from another connection
+	_arrivals.reset();
+};
 
-// MARK: - Internal
 
-int Core::getChannelCountByBody() {
-	return getChannelCountByJoint() * 15;
-}
+// MARK: - Internal
 
-int Core::getChannelCountByJoint() {
-	unsigned short int count = 0;
+unsigned Core::getOutputs() {
+	unsigned outputs = 0;
 
 	if(_outputPositions)
-		count += 3;
+		outputs |= Frame::positions;
 
 	if(_outputOrientations)
-		count += 3;
+		outputs |= Frame::orientations;
 
 	if(_outputConfidences)
-		count += 2;
+		outputs |= Frame::confidences;
 
-	return count;
+	if(_outputVelocities)
+		outputs |= Frame::velocities;
+
+	if(_outputAccelerations)
+		outputs |= Frame::accelerations;
+
+	if(_fixedSlots)
+		outputs |= Frame::fixedSlots;
+
+	if(_bodySamples)
+		outputs |= Frame::bodySamples;
+
+	return outputs;
 }
 
-unsigned long Core::getBodyIndex(const pb::bodyUID &bodyUID) {
-	if(_bodiesIndex.find(bodyUID) != _bodiesIndex.end())
-		return _bodiesIndex[bodyUID];
+Frame * Core::acquireFrame() {
+	Frame * frame = _pipeline.acquire();
+	size_t maxBodies = _maxBodies.load(std::memory_order_relaxed);
 
-	_bodiesIndex[bodyUID] = _bodiesIndex.size();
-	return _bodiesIndex[bodyUID];
+	if(frame->capacity() != maxBodies) {
+		frame->reserve(maxBodies);
+		_bodyAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	_slots.resize(maxBodies);
+
+	// A held body keeps its slot, so it resumes in place when it comes back
+	_slots.setTimeout(std::max(_slotTimeout.load(std::memory_order_relaxed), _holdTime.load(std::memory_order_relaxed)));
+
+	if(_resetSlots.exchange(false, std::memory_order_relaxed)) {
+		_slots.reset();
+		_hold.reset();
+		_oneEuro.reset();
+		_kalman.reset();
+		_motion.reset();
+	}
+
+	frame->clear();
+	frame->timestamp = Frame::now();
+	return frame;
 }
 
-std::string Core::getJointName(const int &jointIndex) {
-	switch(jointIndex) {
-		case  0: return "head";
-		case  1: return "neck";
-		case  2: return "leftShoulder";
-		case  3: return "rightShoulder";
-		case  4: return "leftElbow";
-		case  5: return "rightElbow";
-		case  6: return "leftHand";
-		case  7: return "rightHand";
-		case  8: return "torso";
-		case  9: return "leftHip";
-		case 10: return "rightHip";
-		case 11: return "leftKnee";
-		case 12: return "rightKnee";
-		case 13: return "leftFoot";
-		case 14: return "rightFoot";
-		default: return std::to_string(jointIndex);
+void Core::publishFrame(Frame * frame) {
+	// Merge the bodies closer than the fusion radius, before they get their slots
+	_fusion.setRadius(_fusionRadius.load(std::memory_order_relaxed));
+	_fusion.fuse(*frame);
+	_fusedBodies.store(_fusion.fusedBodies(), std::memory_order_relaxed);
+
+	_slots.assign(*frame);
+
+	// Keep the bodies lost recently in their slots
+	_hold.setGracePeriod(_holdTime.load(std::memory_order_relaxed), _holdFade.load(std::memory_order_relaxed));
+
+	if(_hold.gracePeriod() > 0)
+		_hold.apply(*frame);
+
+	// Smooth the joints, now that the bodies are matched to their slots
+	switch(_smoothing.load(std::memory_order_relaxed)) {
+		case oneEuro:
+			_oneEuro.setParameters(_minCutoff.load(std::memory_order_relaxed),
+								   _beta.load(std::memory_order_relaxed),
+								   _derivativeCutoff.load(std::memory_order_relaxed));
+			_oneEuro.filter(*frame);
+			break;
+		case kalman:
+			_kalman.setParameters(_processNoise.load(std::memory_order_relaxed),
+								  _measurementNoise.load(std::memory_order_relaxed),
+								  _coastTime.load(std::memory_order_relaxed));
+			_kalman.filter(*frame);
+			break;
+		case noSmoothing: default: break;
 	}
+
+	// Derive the motion of the joints, from every frame received
+	_motion.push(*frame);
+	_motion.write(*frame);
+
+	// We are the only publisher, the frame will get the next generation
+	frame->transitDelay = (float)(frame->timestamp - _arrivals.schedule(_pipeline.generation() + 1, frame->timestamp));
+
+	// Lay the frame out as CHOP channels, so the cook only has to copy it
+	int outputs = _prepackOutputs.load(std::memory_order_relaxed);
+
+	if(outputs >= 0)
+		packFrame(*frame, outputs);
+
+	_pipeline.publish(frame);
 }
 
-std::string Core::getJointChannelName(const int &index) {
+void Core::packFrame(Frame &frame, const unsigned &outputs) {
+	auto start = std::chrono::steady_clock::now();
+	frame.pack(outputs);
+	_packTime.store(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+}
 
-	int i = index;
+std::vector<Frame *> &Core::heldFrames() {
+	return _jitter.delay() > 0 ? _released : _frames;
+}
+
+Frame &Core::currentFrame() {
+	std::vector<Frame *> &frames = heldFrames();
+	return frames.empty() ? _emptyFrame : *frames.back();
+}
+
+bool Core::areChannelNamesValid(const Frame &frame) {
+	if(_namedOutputs != (int)getOutputs())
+		return false;
+
+	// With bodies as samples, names only depend on the outputs
+	if(_bodySamples)
+		return true;
 
-	if(_outputPositions) {
-		switch(i) {
-			case  0: return "tx";
-			case  1: return "ty";
-			case  2: return "tz";
-			default: i -= 3;
+	// In fixed slots, names only depend on the number of slots
+	if(_fixedSlots)
+		return _namedSlots == frame.capacity();
+
+	return _namedBodySlots.size() == frame.bodyCount &&
+		std::equal(_namedBodySlots.begin(), _namedBodySlots.end(), frame.slots.begin());
+}
+
+void Core::updateChannelNames(const Frame &frame) {
+	// List the channels of a joint
+	std::vector<const char *> jointChannels;
+
+	if(_outputPositions)
+		jointChannels.insert(jointChannels.end(), std::begin(positionChannels), std::end(positionChannels));
+
+	if(_outputOrientations)
+		jointChannels.insert(jointChannels.end(), std::begin(orientationChannels), std::end(orientationChannels));
+
+	if(_outputVelocities)
+		jointChannels.insert(jointChannels.end(), std::begin(velocityChannels), std::end(velocityChannels));
+
+	if(_outputAccelerations)
+		jointChannels.insert(jointChannels.end(), std::begin(accelerationChannels), std::end(accelerationChannels));
+
+	if(_outputConfidences)
+		jointChannels.insert(jointChannels.end(), std::begin(confidenceChannels), std::end(confidenceChannels));
+
+	_channelNames.resize(frame.channelCount(getOutputs()));
+
+	if(_bodySamples) {
+		_channelNames[0] = "body";
+		_channelNames[1] = "active";
+		size_t c = 2;
+
+		for(const char * joint: jointNames) {
+			for(const char * channel: jointChannels) {
+				_channelNames[c++].assign(joint).append(":").append(channel);
+			}
 		}
+
+		_namedOutputs = getOutputs();
+		return;
 	}
 
-	if(_outputOrientations) {
-		switch(i) {
-			case  0: return "rx";
-			case  1: return "ry";
-			case  2: return "rz";
-			case  4: return "rw";
-			default: i -= 4;
+	// First channel is the number of bodies
+	_channelNames[0] = "body_count";
+	size_t c = 1;
+
+	auto nameBody = [&] (const unsigned long &index, const bool &withActive) {
+		std::string body = "body" + std::to_string(index) + "/";
+
+		if(withActive)
+			_channelNames[c++].assign(body).append("active");
+
+		for(const char * joint: jointNames) {
+			for(const char * channel: jointChannels) {
+				_channelNames[c++].assign(body).append(joint).append(":").append(channel);
+			}
 		}
-	}
+	};
 
-	if(_outputConfidences) {
-		switch(i) {
-			case  0: return "tconf";
-			case  1: return "rconf";
-			default: i -= 2;
+	if(_fixedSlots) {
+		for(size_t s = 0; s < frame.capacity(); ++s) {
+			nameBody(s, true);
+		}
+	} else {
+		for(size_t b = 0; b < frame.bodyCount; ++b) {
+			nameBody(frame.slots[b], false);
 		}
 	}
 
-	return std::to_string(index);
+	_namedBodySlots.assign(frame.slots.begin(), frame.slots.begin() + frame.bodyCount);
+	_namedOutputs = getOutputs();
+	_namedSlots = frame.capacity();
 }
-
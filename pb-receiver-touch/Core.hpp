@@ -8,16 +8,26 @@
 #include <map>
 #include <set>
 #include <mutex>
+#include <atomic>
 
 #include "libs/CHOP_CPlusPlusBase.h"
 
 #include <pb-common/common.hpp>
-#include <pb-common/Utils/PBReceiver.hpp>
 #include <pb-common/messages.hpp>
 
-namespace pb {
-struct Body;
-}
+#include "Frame.hpp"
+#include "FramePipeline.hpp"
+#include "ReceiverHub.hpp"
+#include "BodySlots.hpp"
+#include "BodyHold.hpp"
+#include "BodyFusion.hpp"
+#include "Resampler.hpp"
+#include "ArrivalSchedule.hpp"
+#include "JitterBuffer.hpp"
+#include "MotionHistory.hpp"
+#include "Extrapolator.hpp"
+#include "OneEuroFilter.hpp"
+#include "KalmanFilter.hpp"
 
 /*
 
@@ -36,7 +46,7 @@ If no input is connected then the node will output a smooth sine wave at 120hz.
 
 
 // To get more help about these functions, look at CHOP_CPlusPlusBase.h
-class Core : public CHOP_CPlusPlusBase, public pb::PBReceiverObserver
+class Core : public CHOP_CPlusPlusBase, public ReceiverHub::Observer
 {
 public:
 
@@ -69,23 +79,28 @@ public:
 	virtual void		pulsePressed(const char * name,
 								void * reserved1) override;
 
+	virtual int32_t
+	getNumInfoCHOPChans(void *reserved1) override;
+
+	virtual void
+	getInfoCHOPChan(int32_t index, OP_InfoCHOPChan *chan, void *reserved1) override;
+
 	virtual void
 	getWarningString(OP_String *warning, void *reserved1) override;
 
-	// MARK: - PB Receiver Observer
+	// MARK: - Receiver Hub Observer
 
-	virtual void receiverDidConnect(pb::PBReceiver *) override;
+	virtual void hubDidUpdate(ReceiverHub *, const Frame &snapshot) override;
 
-	virtual void receiverDidUpdate(pb::PBReceiver *) override;
+	virtual void hubDidClose(ReceiverHub *) override;
 
-	virtual void receiverDidClose(pb::PBReceiver *) override;
+	/// Tells if the op has not been cooked for `Pbidleframes` frames, and skips the frames received
+	virtual bool isIdle() const override;
 
 private:
 
 	// MARK: - Internal
 
-	bool _isConnected = false;
-
 	/// Tell if we should output the positions channel
 	bool _outputPositions = false;
 
@@ -95,26 +110,171 @@ private:
 	/// Tell if we should output the confidences
 	bool _outputConfidences = false;
 
-	/// Link to the master
-	pb::PBReceiver _receiver;
+	/// Tell if we should output the velocities
+	bool _outputVelocities = false;
+
+	/// Tell if we should output the accelerations
+	bool _outputAccelerations = false;
+
+	/// Tell if we should output a fixed number of body slots
+	bool _fixedSlots = false;
+
+	/// Tell if we should output one sample per body instead of one channel block per body
+	bool _bodySamples = false;
+
+	/// Tell if we should output every frame received since the last cook, one per sample
+	bool _timeslice = false;
+
+	/// Outputs the receive thread packs frames with, -1 to leave packing to the cook thread
+	std::atomic<int> _prepackOutputs {-1};
+
+	/// Generation of the frame output by the last cook
+	unsigned long _cookedGeneration = 0;
+
+	/// Number of cooks that had no new frame to output
+	unsigned long _staleCooks = 0;
+
+	/// Duration of the last frame packing, on either thread, in microseconds
+	std::atomic<float> _packTime {0};
+
+	/// Time between the reception of the frame output by the last cook and the cook, in seconds
+	double _frameAge = 0;
+
+	/// Time the newest frame waited between its publication and the cook that took it, in seconds
+	double _queueTime = 0;
+
+	/// Jitter-free arrival of the frames, to measure their transit delay. Receive thread only.
+	ArrivalSchedule _arrivals;
+
+	/// Maximum number of bodies in a frame, set at cook time and applied on the receive thread
+	std::atomic<size_t> _maxBodies {16};
+
+	/// Number of frame storage allocations made by the receive thread since the op was created
+	std::atomic<unsigned long> _bodyAllocations {0};
+
+	/// Output slots of the bodies, assigned on the receive thread
+	BodySlots _slots;
+
+	/// How long the slot of a missing body is kept for it, in seconds
+	std::atomic<float> _slotTimeout {2};
+
+	/// Set by the reset pulse, consumed by the receive thread
+	std::atomic<bool> _resetSlots {false};
+
+	/// Number of frames received without a cook before going idle, 0 to never go idle
+	std::atomic<unsigned> _idleFrames {30};
+
+	/// Number of frames received since the last cook
+	std::atomic<unsigned> _uncookedFrames {0};
+
+	/// Fuses the bodies closer than the fusion radius, duplicates or not. Receive thread only.
+	BodyFusion _fusion;
+
+	/// Distance under which two bodies are fused, in meters, 0 to never fuse them
+	std::atomic<float> _fusionRadius {0};
+
+	/// Number of bodies removed by the fusion from the last frame
+	std::atomic<size_t> _fusedBodies {0};
+
+	/// Holds the bodies lost by the tracking, assigned on the receive thread
+	BodyHold _hold;
+
+	/// How long a lost body is held, in seconds, and if it fades out meanwhile
+	std::atomic<float> _holdTime {0};
+	std::atomic<bool> _holdFade {false};
+
+	/// Smoothing applied to the frames on the receive thread, as listed in the Pbsmoothing menu
+	enum Smoothing: int {
+		noSmoothing = 0,
+		oneEuro = 1,
+		kalman = 2
+	};
+
+	std::atomic<int> _smoothing {noSmoothing};
+
+	/// One Euro filter parameters, set at cook time
+	std::atomic<float> _minCutoff {1};
+	std::atomic<float> _beta {.5f};
+	std::atomic<float> _derivativeCutoff {1};
+
+	/// Kalman filter parameters, set at cook time
+	std::atomic<float> _processNoise {3};
+	std::atomic<float> _measurementNoise {.02f};
+	std::atomic<float> _coastTime {.5f};
+
+	/// Smooths the frames when the One Euro smoothing is selected. Receive thread only.
+	OneEuroFilter _oneEuro;
+
+	/// Smooths the frames when the Kalman smoothing is selected. Receive thread only.
+	KalmanFilter _kalman;
+
+	/// Motion of the bodies, written in every frame. Receive thread only.
+	MotionHistory _motion;
+
+	/// Link to the master, shared with the other ops
+	std::shared_ptr<ReceiverHub> _hub;
+
+	/// Frames built by the receive thread, waiting to be cooked
+	FramePipeline _pipeline;
+
+	/// Frames held for the current cook, oldest first
+	std::vector<Frame *> _frames;
+
+	/// Frames output by the current cook, one per sample, oldest first
+	std::vector<Frame *> _samples;
+
+	/// Index of the first sample of the next cook on the timeline
+	uint32_t _startIndex = 0;
+
+	/// Resamples the frames at a fixed rate, when enabled
+	Resampler _resampler;
+
+	/// Delays and paces the frames received, when enabled
+	JitterBuffer _jitter;
+
+	/// Frames released by the jitter buffer for the current cook, oldest first
+	std::vector<Frame *> _released;
+
+	/// Predicts the samples ahead of the stream, when enabled
+	Extrapolator _extrapolator;
+
+	/// Frame used until the first one is received
+	Frame _emptyFrame;
+
+	/// Name of every output channel, rebuilt only when the bodies or the outputs change
+	std::vector<std::string> _channelNames;
+
+	/// Slots of the bodies `_channelNames` was built for
+	std::vector<unsigned> _namedBodySlots;
+
+	/// Outputs `_channelNames` was built for, -1 if it is empty
+	int _namedOutputs = -1;
+
+	/// Number of slots `_channelNames` was built for
+	size_t _namedSlots = 0;
+
 
-	std::vector<pb::Body *> _bodies;
+	/// Gives the current output selection as Frame::Output flags
+	unsigned getOutputs();
 
-	std::map<pb::bodyUID, unsigned long> _bodiesIndex;
+	/// Gives an empty frame to fill, sized for the current maximum number of bodies. Receive thread only.
+	Frame * acquireFrame();
 
+	/// Fuses the duplicated bodies of the frame, assigns them to their slots, packs it if needed, and hands it to the cook thread. Receive thread only.
+	void publishFrame(Frame * frame);
 
-	/// Tells how many channel each Body requires for output base on the current users parameters
-	int getChannelCountByBody();
+	/// Packs the frame in its own buffer and measures how long it took
+	void packFrame(Frame &frame, const unsigned &outputs);
 
-	/// Tells how many channel each Joint requires for output base on the current users parameters
-	int getChannelCountByJoint();
+	/// Gives the frames held for the current cook, from the jitter buffer if it is enabled
+	std::vector<Frame *> &heldFrames();
 
-	/// Gives the corresponding body index for the given body UID. If tthe body isn't references, this method does it.
-	unsigned long getBodyIndex(const pb::bodyUID &bodyUID);
+	/// Gives the most recent frame held for the current cook
+	Frame &currentFrame();
 
-	/// Gives the name of the specified joint based on its index
-	std::string getJointName(const int &jointIndex);
+	/// Tells if the channel names match the bodies of the given frame and the current outputs
+	bool areChannelNamesValid(const Frame &frame);
 
-	/// Gives the name of a channel based on its index in the joint and the current users parameters
-	std::string getJointChannelName(const int &index);
+	/// Rebuilds the name of all the channels for the given frame and the current outputs
+	void updateChannelNames(const Frame &frame);
 };
@@ -0,0 +1,73 @@
+//
+//  Extrapolator.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+
+#include "Extrapolator.hpp"
+
+void Extrapolator::setHorizon(const double &horizon) {
+	if(horizon == _horizon)
+		return;
+
+	_horizon = horizon;
+	_dirty = true;
+}
+
+void Extrapolator::process(std::vector<Frame *> &samples) {
+	if(_predictions.size() < samples.size()) {
+		_predictions.resize(samples.size());
+		_dirty = true;
+	}
+
+	for(size_t s = 0; s < samples.size(); ++s) {
+		const Frame &sample = *samples[s];
+		Frame &prediction = _predictions[s];
+
+		// A stale cook gets the same predictions as the previous one
+		if(_dirty || prediction.generation != sample.generation || prediction.timestamp != sample.timestamp + _horizon)
+			predict(sample, prediction);
+
+		samples[s] = &prediction;
+	}
+
+	_dirty = false;
+}
+
+void Extrapolator::predict(const Frame &frame, Frame &prediction) const {
+	prediction.assign(frame);
+	prediction.timestamp = frame.timestamp + _horizon;
+
+	const float h = (float)_horizon;
+	const float h2 = .5f * h * h;
+
+	const size_t joints = frame.jointsSize();
+
+	const float * vx = frame.velocityX.data();
+	const float * vy = frame.velocityY.data();
+	const float * vz = frame.velocityZ.data();
+	const float * ax = frame.accelerationX.data();
+	const float * ay = frame.accelerationY.data();
+	const float * az = frame.accelerationZ.data();
+	const float * confidence = frame.motionConfidence.data();
+
+	float * px = prediction.positionX.data();
+	float * py = prediction.positionY.data();
+	float * pz = prediction.positionZ.data();
+
+	// Branchless over all the joints, so it vectorizes. The motion is damped
+	// by the confidence of the joint, and the acceleration, noisier, is
+	// damped twice. Joints without a known motion have a zero confidence.
+	for(size_t j = 0; j < joints; ++j) {
+		const float d = confidence[j];
+		const float dv = d * h;
+		const float da = d * d * h2;
+
+		px[j] += vx[j] * dv + ax[j] * da;
+		py[j] += vy[j] * dv + ay[j] * da;
+		pz[j] += vz[j] * dv + az[j] * da;
+	}
+}
@@ -0,0 +1,49 @@
+//
+//  Extrapolator.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef Extrapolator_hpp
+#define Extrapolator_hpp
+
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Predicts the joints positions ahead of the received frames, to hide the
+/// latency of the stream.
+///
+/// Samples are moved forward by the horizon along the motion the receive
+/// thread wrote in them. The prediction is damped by the motion confidence of
+/// the joint, so joints poorly tracked stay in place. Orientations are left
+/// untouched. Cook thread only.
+class Extrapolator {
+public:
+
+	/// Sets how far ahead samples are predicted, in seconds
+	void setHorizon(const double &horizon);
+
+	inline double horizon() const {
+		return _horizon;
+	}
+
+	/// Replaces each sample with its prediction. Predictions stay valid until the next call.
+	void process(std::vector<Frame *> &samples);
+
+private:
+
+	double _horizon = 0;
+
+	/// Tells if the predictions must be redone whatever their samples
+	bool _dirty = true;
+
+	/// Storage for the predictions
+	std::vector<Frame> _predictions;
+
+	/// Writes in `prediction` the frame moved forward by the horizon
+	void predict(const Frame &frame, Frame &prediction) const;
+};
+
+#endif /* Extrapolator_hpp */
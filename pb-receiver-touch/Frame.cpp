@@ -0,0 +1,265 @@
+//
+//  Frame.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+
+#include <pb-common/Structs/Body.hpp>
+
+#include "Frame.hpp"
+
+void Frame::reserve(const size_t &capacity) {
+	size_t size = capacity * jointCount;
+
+	bodyCount = 0;
+	uids.resize(capacity);
+	slots.resize(capacity);
+
+	for(std::vector<float> * component: {
+		&positionX, &positionY, &positionZ,
+		&orientationX, &orientationY, &orientationZ, &orientationW,
+		&positionConfidence, &orientationConfidence,
+		&velocityX, &velocityY, &velocityZ,
+		&accelerationX, &accelerationY, &accelerationZ,
+		&motionConfidence}) {
+		component->assign(size, 0.f);
+	}
+
+	// Large enough for any layout, bodies as samples being the largest
+	packed.assign(1 + std::max<size_t>(capacity, 1) * (2 + jointCount * maxChannelsByJoint), 0.f);
+	packedOutputs = -1;
+}
+
+bool Frame::push(pb::Body &body) {
+	if(bodyCount == capacity())
+		return false;
+
+	size_t i = bodyCount * jointCount;
+	size_t end = i + jointCount;
+
+	for(pb::Joint &joint: body.skeleton()->joints) {
+		if(i == end)
+			break;
+
+		positionX[i] = joint.position.x;
+		positionY[i] = joint.position.y;
+		positionZ[i] = joint.position.z;
+
+		orientationX[i] = joint.orientation.x;
+		orientationY[i] = joint.orientation.y;
+		orientationZ[i] = joint.orientation.z;
+		orientationW[i] = joint.orientation.w;
+
+		positionConfidence[i] = joint.positionConfidence;
+		orientationConfidence[i] = joint.orientationConfidence;
+
+		++i;
+	}
+
+	// Missing joints are output with no confidence
+	for(; i < end; ++i) {
+		positionConfidence[i] = 0.f;
+		orientationConfidence[i] = 0.f;
+	}
+
+	uids[bodyCount++] = body.uid;
+	return true;
+}
+
+void Frame::assign(const Frame &frame) {
+	generation = frame.generation;
+	timestamp = frame.timestamp;
+	published = frame.published;
+	transitDelay = frame.transitDelay;
+	bodyCount = frame.bodyCount;
+
+	uids = frame.uids;
+	slots = frame.slots;
+
+	positionX = frame.positionX;
+	positionY = frame.positionY;
+	positionZ = frame.positionZ;
+
+	orientationX = frame.orientationX;
+	orientationY = frame.orientationY;
+	orientationZ = frame.orientationZ;
+	orientationW = frame.orientationW;
+
+	positionConfidence = frame.positionConfidence;
+	orientationConfidence = frame.orientationConfidence;
+
+	velocityX = frame.velocityX;
+	velocityY = frame.velocityY;
+	velocityZ = frame.velocityZ;
+
+	accelerationX = frame.accelerationX;
+	accelerationY = frame.accelerationY;
+	accelerationZ = frame.accelerationZ;
+
+	motionConfidence = frame.motionConfidence;
+
+	packed.resize(frame.packed.size());
+	packedOutputs = -1;
+}
+
+void Frame::copyBody(const Frame &frame, const size_t &from, const size_t &to) {
+	uids[to] = frame.uids[from];
+	slots[to] = frame.slots[from];
+
+	const size_t source = from * jointCount;
+	const size_t destination = to * jointCount;
+
+	for(std::vector<float> Frame::* component: {
+		&Frame::positionX, &Frame::positionY, &Frame::positionZ,
+		&Frame::orientationX, &Frame::orientationY, &Frame::orientationZ, &Frame::orientationW,
+		&Frame::positionConfidence, &Frame::orientationConfidence,
+		&Frame::velocityX, &Frame::velocityY, &Frame::velocityZ,
+		&Frame::accelerationX, &Frame::accelerationY, &Frame::accelerationZ,
+		&Frame::motionConfidence}) {
+		std::copy_n((frame.*component).begin() + source, jointCount, (this->*component).begin() + destination);
+	}
+}
+
+// MARK: - Packing
+
+const std::array<Frame::PackKernel, Frame::kernelOutputs + 1> Frame::packKernels =
+	Frame::makePackKernels(std::make_index_sequence<Frame::kernelOutputs + 1>());
+
+template<size_t ... Outputs>
+std::array<Frame::PackKernel, sizeof...(Outputs)> Frame::makePackKernels(std::index_sequence<Outputs...>) {
+	return {{ &Frame::packJoints<Outputs>... }};
+}
+
+void Frame::pack(const unsigned &outputs) {
+	pack(outputs, packed.data());
+	packedOutputs = outputs;
+}
+
+void Frame::pack(const unsigned &outputs, float * block) const {
+	// Select the kernel once for the whole frame
+	const PackKernel packJoints = packKernels[outputs & kernelOutputs];
+
+	if(outputs & bodySamples) {
+		packSamples(outputs, packJoints, block);
+		return;
+	}
+
+	// First channel is the body count
+	*block++ = bodyCount;
+
+	if(!(outputs & fixedSlots)) {
+		(this->*packJoints)(0, jointsSize(), block);
+		return;
+	}
+
+	// Empty slots are output as zeros
+	const size_t slotChannels = channelsBySlot(outputs);
+	std::fill(block, block + capacity() * slotChannels, 0.f);
+
+	for(size_t b = 0; b < bodyCount; ++b) {
+		float * slot = block + slots[b] * slotChannels;
+
+		*slot++ = 1.f;
+		(this->*packJoints)(b * jointCount, (b + 1) * jointCount, slot);
+	}
+}
+
+void Frame::packSamples(const unsigned &outputs, const PackKernel &packJoints, float * block) const {
+	const size_t samples = sampleCount(outputs);
+	const size_t jointChannels = jointCount * channelsByJoint(outputs);
+	const bool fixed = outputs & fixedSlots;
+
+	// Empty samples are output as zeros, their body being their slot
+	std::fill(block, block + (2 + jointChannels) * samples, 0.f);
+
+	for(size_t s = 0; fixed && s < samples; ++s) {
+		block[s] = s;
+	}
+
+	// Joints are packed body by body, then spread over the channels
+	float body[jointCount * maxChannelsByJoint];
+
+	for(size_t b = 0; b < bodyCount; ++b) {
+		const size_t s = fixed ? slots[b] : b;
+
+		block[s] = slots[b];
+		block[samples + s] = 1.f;
+
+		(this->*packJoints)(b * jointCount, (b + 1) * jointCount, body);
+
+		float * sample = block + 2 * samples + s;
+
+		for(size_t c = 0; c < jointChannels; ++c) {
+			sample[c * samples] = body[c];
+		}
+	}
+}
+
+template<unsigned Outputs>
+float * Frame::packJoints(const size_t &begin, const size_t &end, float * block) const {
+	constexpr unsigned stride = channelsByJoint(Outputs);
+	constexpr unsigned orientationsOffset = (Outputs & positions) ? 3 : 0;
+	constexpr unsigned velocitiesOffset = orientationsOffset + ((Outputs & orientations) ? 3 : 0);
+	constexpr unsigned accelerationsOffset = velocitiesOffset + ((Outputs & velocities) ? 3 : 0);
+	constexpr unsigned confidencesOffset = accelerationsOffset + ((Outputs & accelerations) ? 3 : 0);
+
+	const float * px = positionX.data();
+	const float * py = positionY.data();
+	const float * pz = positionZ.data();
+	const float * ox = orientationX.data();
+	const float * oy = orientationY.data();
+	const float * oz = orientationZ.data();
+	const float * vx = velocityX.data();
+	const float * vy = velocityY.data();
+	const float * vz = velocityZ.data();
+	const float * ax = accelerationX.data();
+	const float * ay = accelerationY.data();
+	const float * az = accelerationZ.data();
+	const float * pc = positionConfidence.data();
+	const float * oc = orientationConfidence.data();
+
+	for(size_t i = begin; i < end; ++i, block += stride) {
+		if(Outputs & positions) {
+			const bool valid = pc[i] > 0.f && pc[i] <= 1.f;
+
+			block[0] = valid ? px[i] : 0.f;
+			block[1] = valid ? py[i] : 0.f;
+			block[2] = valid ? -pz[i] : 0.f;
+		}
+
+		if(Outputs & orientations) {
+			const bool valid = oc[i] > 0.f && oc[i] <= 1.f;
+
+			block[orientationsOffset + 0] = valid ? ox[i] : 0.f;
+			block[orientationsOffset + 1] = valid ? oy[i] : 0.f;
+			block[orientationsOffset + 2] = valid ? oz[i] : 0.f;
+		}
+
+		// Motion follows the positions
+		if(Outputs & velocities) {
+			const bool valid = pc[i] > 0.f && pc[i] <= 1.f;
+
+			block[velocitiesOffset + 0] = valid ? vx[i] : 0.f;
+			block[velocitiesOffset + 1] = valid ? vy[i] : 0.f;
+			block[velocitiesOffset + 2] = valid ? -vz[i] : 0.f;
+		}
+
+		if(Outputs & accelerations) {
+			const bool valid = pc[i] > 0.f && pc[i] <= 1.f;
+
+			block[accelerationsOffset + 0] = valid ? ax[i] : 0.f;
+			block[accelerationsOffset + 1] = valid ? ay[i] : 0.f;
+			block[accelerationsOffset + 2] = valid ? -az[i] : 0.f;
+		}
+
+		if(Outputs & confidences) {
+			block[confidencesOffset + 0] = pc[i];
+			block[confidencesOffset + 1] = oc[i];
+		}
+	}
+
+	return block;
+}
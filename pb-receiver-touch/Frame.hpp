@@ -0,0 +1,211 @@
+//
+//  Frame.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef Frame_hpp
+#define Frame_hpp
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include <pb-common/common.hpp>
+
+namespace pb {
+struct Body;
+}
+
+/// A snapshot of the receiver's arena, built on the receive thread and
+/// handed to the cook thread as a whole.
+///
+/// Joints are stored as a structure of arrays: each component has its own
+/// contiguous array, indexed by `body * jointCount + joint`. Storage is sized
+/// once for the maximum number of bodies and reused from one frame to the next.
+///
+/// A frame can also be packed: its values are then laid out exactly as the
+/// CHOP channels, ready to be copied in the output.
+struct Frame {
+	/// Number of joints in a skeleton
+	static constexpr size_t jointCount = 15;
+
+	/// Components output for each joint
+	enum Output: unsigned {
+		positions = 1 << 0,
+		orientations = 1 << 1,
+		confidences = 1 << 2,
+		velocities = 1 << 3,
+		accelerations = 1 << 4,
+
+		/// Not an output: lays the channels out in `capacity()` fixed
+		/// body slots, each with an `active` channel, instead of one
+		/// block per tracked body.
+		fixedSlots = 1 << 5,
+
+		/// Not an output: outputs one sample per body, and one channel per
+		/// joint component, after a `body` and an `active` channel. With
+		/// fixed slots, there is one sample per slot.
+		bodySamples = 1 << 6
+	};
+
+	/// Maximum number of channels output for each joint
+	static constexpr size_t maxChannelsByJoint = 14;
+
+	/// Position of the frame in the stream, set when the frame is published
+	unsigned long generation = 0;
+
+	/// Time the frame was received, in seconds
+	double timestamp = 0;
+
+	/// Time the frame was handed to the cook thread, in seconds
+	double published = 0;
+
+	/// Delay of the frame over the fastest transit seen, in seconds
+	float transitDelay = 0;
+
+	/// Number of bodies in the frame
+	size_t bodyCount = 0;
+
+	/// UID of each body
+	std::vector<pb::bodyUID> uids;
+
+	/// Output slot of each body, used by the fixed slots layout
+	std::vector<unsigned> slots;
+
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+
+	std::vector<float> orientationX;
+	std::vector<float> orientationY;
+	std::vector<float> orientationZ;
+	std::vector<float> orientationW;
+
+	std::vector<float> positionConfidence;
+	std::vector<float> orientationConfidence;
+
+	/// Motion of the joints, in units per second and per second squared
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> velocityZ;
+
+	std::vector<float> accelerationX;
+	std::vector<float> accelerationY;
+	std::vector<float> accelerationZ;
+
+	/// Lowest confidence of the joints the motion was estimated from, from 0 to 1
+	std::vector<float> motionConfidence;
+
+	/// Channel-major values, valid if `packedOutputs` is not -1
+	std::vector<float> packed;
+
+	/// Outputs used to build `packed`, -1 if the frame is not packed
+	int packedOutputs = -1;
+
+	/// Current time on the clock used for frame timestamps, in seconds
+	static inline double now() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/// Maximum number of bodies the frame can hold
+	inline size_t capacity() const {
+		return uids.size();
+	}
+
+	/// Number of joints in the frame
+	inline size_t jointsSize() const {
+		return bodyCount * jointCount;
+	}
+
+	/// Removes all the bodies and sets the new capacity
+	void reserve(const size_t &capacity);
+
+	/// Removes all the bodies from the frame, keeping the storage
+	inline void clear() {
+		bodyCount = 0;
+		packedOutputs = -1;
+	}
+
+	/// Copies the given body at the end of the frame. Returns false if the frame is full
+	bool push(pb::Body &body);
+
+	/// Copies the bodies of the given frame, without its packing. Storage is
+	/// reused if the capacities match.
+	void assign(const Frame &frame);
+
+	/// Copies the body at index `from` of the given frame, with its UID and
+	/// slot, over the body at index `to` of this one. Both must be within
+	/// capacity, `bodyCount` is left untouched.
+	void copyBody(const Frame &frame, const size_t &from, const size_t &to);
+
+	// MARK: - Packing
+
+	/// Number of channels output for each joint with the given outputs
+	static constexpr unsigned channelsByJoint(const unsigned &outputs) {
+		return ((outputs & positions) ? 3 : 0) +
+			   ((outputs & orientations) ? 3 : 0) +
+			   ((outputs & velocities) ? 3 : 0) +
+			   ((outputs & accelerations) ? 3 : 0) +
+			   ((outputs & confidences) ? 2 : 0);
+	}
+
+	/// Number of channels output for each body slot with the given outputs, `active` channel included
+	static inline size_t channelsBySlot(const unsigned &outputs) {
+		return 1 + jointCount * channelsByJoint(outputs);
+	}
+
+	/// Number of channels needed to output the frame, body count or body and active channels included
+	inline size_t channelCount(const unsigned &outputs) const {
+		if(outputs & bodySamples)
+			return 2 + jointCount * channelsByJoint(outputs);
+
+		if(outputs & fixedSlots)
+			return 1 + capacity() * channelsBySlot(outputs);
+
+		return 1 + jointsSize() * channelsByJoint(outputs);
+	}
+
+	/// Number of samples needed to output the frame. Always at least one.
+	inline size_t sampleCount(const unsigned &outputs) const {
+		if(!(outputs & bodySamples))
+			return 1;
+
+		return std::max<size_t>((outputs & fixedSlots) ? capacity() : bodyCount, 1);
+	}
+
+	/// Packs the frame in its own `packed` buffer
+	void pack(const unsigned &outputs);
+
+	/// Writes the frame, as CHOP channels, in the given block. The block must
+	/// hold at least `channelCount(outputs) * sampleCount(outputs)` values,
+	/// channel after channel.
+	void pack(const unsigned &outputs, float * block) const;
+
+private:
+
+	/// Output flags handled by the packing kernels
+	static constexpr unsigned kernelOutputs = positions | orientations | confidences | velocities | accelerations;
+
+	typedef float * (Frame::*PackKernel)(const size_t &, const size_t &, float *) const;
+
+	/// Packing kernel of each combination of outputs, indexed by `outputs & kernelOutputs`
+	static const std::array<PackKernel, kernelOutputs + 1> packKernels;
+
+	template<size_t ... Outputs>
+	static std::array<PackKernel, sizeof...(Outputs)> makePackKernels(std::index_sequence<Outputs...>);
+
+	/// Writes the frame with one sample per body in the given block
+	void packSamples(const unsigned &outputs, const PackKernel &packJoints, float * block) const;
+
+	/// Writes the joints in [begin, end[ as CHOP channels in the given block. Returns the end of the written values.
+	/// Outputs being known at compile time, the channel stride is constant and the output tests are
+	/// resolved once, outside of the loop.
+	template<unsigned Outputs>
+	float * packJoints(const size_t &begin, const size_t &end, float * block) const;
+};
+
+#endif /* Frame_hpp */
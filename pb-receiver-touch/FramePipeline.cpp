@@ -0,0 +1,97 @@
+//
+//  FramePipeline.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+
+#include "FramePipeline.hpp"
+
+FramePipeline::FramePipeline(const size_t &poolSize):
+	_pool(poolSize),
+	_free(poolSize),
+	_ready(poolSize),
+	_drained(poolSize) {
+	for(Frame &frame: _pool) {
+		_free.enqueue(&frame);
+	}
+}
+
+// MARK: - Receive thread
+
+Frame * FramePipeline::acquire() {
+	Frame * frame;
+
+	// The cook thread never holds more than half the pool, so one of the two
+	// queues always has a frame for us.
+	while(!_free.try_dequeue(frame)) {
+		if(_ready.try_dequeue(frame)) {
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			break;
+		}
+	}
+
+	return frame;
+}
+
+void FramePipeline::publish(Frame * frame) {
+	frame->generation = _generation.fetch_add(1, std::memory_order_relaxed) + 1;
+	frame->published = Frame::now();
+	_ready.enqueue(frame);
+}
+
+// MARK: - Cook thread
+
+size_t FramePipeline::consume(std::vector<Frame *> &frames) {
+	// Drain everything published, so the newest frames are always the ones kept
+	size_t count = 0;
+	size_t dequeued;
+
+	while(count < _drained.size() && (dequeued = _ready.try_dequeue_bulk(_drained.begin() + count, _drained.size() - count)) > 0)
+		count += dequeued;
+
+	if(count == 0)
+		return 0;
+
+	// The ready queue only keeps the order of each publishing thread. Frames
+	// are handed oldest first, restore the publish order.
+	const auto isOlder = [] (const Frame * a, const Frame * b) {
+		return a->generation < b->generation;
+	};
+
+	if(!std::is_sorted(_drained.begin(), _drained.begin() + count, isOlder))
+		std::sort(_drained.begin(), _drained.begin() + count, isOlder);
+
+	// Give back the frames from the previous cook
+	recycle(frames);
+
+	size_t keep = count;
+
+	switch(_policy.load(std::memory_order_relaxed)) {
+		case latest: keep = 1; break;
+		case bounded: keep = std::min(count, _depth.load(std::memory_order_relaxed)); break;
+		case drainAll: default: break;
+	}
+
+	// Hold at most half the pool, so the receive thread always finds a frame
+	keep = std::min(keep, _pool.size() / 2 - 1);
+
+	// Drop the oldest frames we are not keeping
+	if(keep < count) {
+		_free.enqueue_bulk(_drained.begin(), count - keep);
+		_dropped.fetch_add(count - keep, std::memory_order_relaxed);
+	}
+
+	frames.insert(frames.end(), _drained.begin() + (count - keep), _drained.begin() + count);
+	return keep;
+}
+
+void FramePipeline::recycle(std::vector<Frame *> &frames) {
+	if(frames.empty())
+		return;
+
+	_free.enqueue_bulk(frames.begin(), frames.size());
+	frames.clear();
+}
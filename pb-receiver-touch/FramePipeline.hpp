@@ -0,0 +1,108 @@
+//
+//  FramePipeline.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef FramePipeline_hpp
+#define FramePipeline_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "libs/concurrentqueue.h"
+
+#include "Frame.hpp"
+
+/// Hands frames built on the receive thread over to the cook thread.
+///
+/// All frames are allocated once, up front, and circulate between a free queue
+/// and a ready queue. The receive thread takes a frame from the free queue,
+/// fills it and publishes it. At cook time, the ready frames are drained
+/// according to the current policy, and the previous ones are given back.
+/// Frames that never reach the cook thread are counted as dropped.
+class FramePipeline {
+public:
+
+	/// How ready frames are handed to the cook thread
+	enum Policy: int {
+		/// Only the most recent frame is kept, the others are dropped
+		latest = 0,
+
+		/// Every frame received since the last cook is kept, up to half the pool size
+		drainAll = 1,
+
+		/// At most `depth` frames are kept, the oldest ones are dropped first
+		bounded = 2
+	};
+
+	FramePipeline(const size_t &poolSize = 64);
+
+	// MARK: - Receive thread
+
+	/// Gives a frame to fill. If every frame is in use, the oldest ready one is recycled.
+	Frame * acquire();
+
+	/// Stamps the given frame with the next generation and the publish time, and makes it available to the cook thread
+	void publish(Frame * frame);
+
+	// MARK: - Cook thread
+
+	/// Replaces the content of `frames` with the frames published since the
+	/// last call, oldest first. If nothing was published, `frames` is left
+	/// untouched and 0 is returned.
+	size_t consume(std::vector<Frame *> &frames);
+
+	// MARK: - Settings
+
+	inline void setPolicy(const Policy &policy) {
+		_policy.store(policy, std::memory_order_relaxed);
+	}
+
+	inline void setDepth(const size_t &depth) {
+		_depth.store(depth < 1 ? 1 : depth, std::memory_order_relaxed);
+	}
+
+	/// Generation of the last published frame. Increases by one with every frame
+	inline unsigned long generation() const {
+		return _generation.load(std::memory_order_relaxed);
+	}
+
+	/// Number of frames dropped since the pipeline was created
+	inline unsigned long droppedFrames() const {
+		return _dropped.load(std::memory_order_relaxed);
+	}
+
+	inline size_t poolSize() const {
+		return _pool.size();
+	}
+
+private:
+
+	/// Storage of all the frames
+	std::vector<Frame> _pool;
+
+	/// Frames ready to be filled
+	moodycamel::ConcurrentQueue<Frame *> _free;
+
+	/// Frames waiting to be cooked
+	moodycamel::ConcurrentQueue<Frame *> _ready;
+
+	/// Drain buffer, only used by the cook thread
+	std::vector<Frame *> _drained;
+
+	std::atomic<int> _policy {latest};
+
+	std::atomic<size_t> _depth {4};
+
+	std::atomic<unsigned long> _dropped {0};
+
+	std::atomic<unsigned long> _generation {0};
+
+	/// Moves the frames to the free queue and clears the vector
+	void recycle(std::vector<Frame *> &frames);
+};
+
+#endif /* FramePipeline_hpp */
@@ -0,0 +1,125 @@
+//
+//  JitterBuffer.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "JitterBuffer.hpp"
+
+/// Largest number of frames the pool grows to
+static constexpr size_t maxPoolSize = 256;
+
+/// Frames kept in the pool on top of the ones received over the delay, for
+/// the frames released and the frames received by a single cook
+static constexpr size_t poolHeadroom = 16;
+
+JitterBuffer::JitterBuffer(const size_t &poolSize): _pool(poolSize) {
+	_free.reserve(maxPoolSize);
+	_buffered.reserve(maxPoolSize);
+
+	for(Frame &frame: _pool) {
+		_free.push_back(&frame);
+	}
+}
+
+void JitterBuffer::setDelay(const double &delay) {
+	if(delay == _delay)
+		return;
+
+	_delay = delay;
+	_schedule.reset();
+
+	for(Entry &entry: _buffered) {
+		_free.push_back(entry.frame);
+	}
+
+	_buffered.clear();
+}
+
+size_t JitterBuffer::process(const std::vector<Frame *> &frames, const size_t &received, const double &now, std::vector<Frame *> &released) {
+	for(size_t f = frames.size() - received; f < frames.size(); ++f) {
+		push(*frames[f], released);
+	}
+
+	// Count the frames due
+	size_t due = 0;
+
+	while(due < _buffered.size() && _buffered[due].release <= now)
+		++due;
+
+	if(due == 0)
+		return 0;
+
+	// Give back the frames released by the previous call, and release the new ones
+	_free.insert(_free.end(), released.begin(), released.end());
+	released.clear();
+
+	for(size_t i = 0; i < due; ++i) {
+		released.push_back(_buffered[i].frame);
+	}
+
+	_buffered.erase(_buffered.begin(), _buffered.begin() + due);
+	return due;
+}
+
+void JitterBuffer::push(const Frame &frame, std::vector<Frame *> &released) {
+	const double arrival = frame.timestamp;
+	const double scheduled = _schedule.schedule(frame.generation, arrival);
+
+	// Buffer no more than half the largest pool, the other half holds the
+	// frames released and received meanwhile. Otherwise the oldest frames
+	// would be dropped before being due, and none would ever be released.
+	const double period = _schedule.period();
+	const double delay = period > 0 ? std::min(_delay, maxPoolSize / 2 * period) : _delay;
+
+	// Ahead of the schedule by more than the delay, the buffer could not
+	// have smoothed it
+	if(_schedule.advance() > delay)
+		++_early;
+
+	double release = scheduled + delay;
+
+	if(arrival > release) {
+		++_late;
+		release = arrival;
+	}
+
+	Frame * copy = acquire(released);
+	copy->assign(frame);
+
+	// Keep the buffer in generation order
+	Entry entry {copy, release};
+	auto position = std::upper_bound(_buffered.begin(), _buffered.end(), entry, [] (const Entry &a, const Entry &b) {
+		return a.frame->generation < b.frame->generation;
+	});
+
+	_buffered.insert(position, entry);
+}
+
+Frame * JitterBuffer::acquire(std::vector<Frame *> &released) {
+	if(_free.empty()) {
+		const double period = _schedule.period();
+		const size_t needed = period > 0 ? (size_t)std::ceil(_delay / period) + poolHeadroom : 0;
+
+		if(_pool.size() < std::min(needed, maxPoolSize)) {
+			_pool.emplace_back();
+			_free.push_back(&_pool.back());
+		} else if(!_buffered.empty()) {
+			_free.push_back(_buffered.front().frame);
+			_buffered.erase(_buffered.begin());
+			++_dropped;
+		} else {
+			// Every frame was released by the last call, reuse the oldest
+			_free.push_back(released.front());
+			released.erase(released.begin());
+		}
+	}
+
+	Frame * frame = _free.back();
+	_free.pop_back();
+	return frame;
+}
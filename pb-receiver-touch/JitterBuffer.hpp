@@ -0,0 +1,100 @@
+//
+//  JitterBuffer.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef JitterBuffer_hpp
+#define JitterBuffer_hpp
+
+#include <deque>
+#include <vector>
+
+#include "ArrivalSchedule.hpp"
+#include "Frame.hpp"
+
+/// Delays the received frames by a fixed amount and releases them evenly paced.
+///
+/// Each frame is released `delay` after its scheduled arrival, the arrival it
+/// would have had without any jitter. Frames arriving after their release time
+/// are late and released right away, frames arriving ahead of their schedule
+/// by more than the delay are early. Frames are kept in generation order.
+///
+/// The pool grows to hold the frames received over the delay, at the measured
+/// frame rate, up to a maximum. Past that, the delay is shortened to what
+/// half the pool can hold. Cook thread only.
+class JitterBuffer {
+public:
+
+	JitterBuffer(const size_t &poolSize = 64);
+
+	/// Sets the target delay, in seconds. Changing it empties the buffer
+	void setDelay(const double &delay);
+
+	inline double delay() const {
+		return _delay;
+	}
+
+	/// Buffers the last `received` frames of `frames`, and replaces the
+	/// content of `released` with the buffered frames due at `now`, oldest
+	/// first. If no frame is due, `released` is left untouched and 0 is
+	/// returned. Released frames stay valid until the next call.
+	size_t process(const std::vector<Frame *> &frames, const size_t &received, const double &now, std::vector<Frame *> &released);
+
+	/// Number of frames waiting to be released
+	inline size_t depth() const {
+		return _buffered.size();
+	}
+
+	inline unsigned long lateFrames() const {
+		return _late;
+	}
+
+	inline unsigned long earlyFrames() const {
+		return _early;
+	}
+
+	/// Number of frames dropped because the pool was full
+	inline unsigned long droppedFrames() const {
+		return _dropped;
+	}
+
+private:
+
+	struct Entry {
+		Frame * frame;
+		double release;
+	};
+
+	double _delay = 0;
+
+	/// Jitter-free arrival of the frames
+	ArrivalSchedule _schedule;
+
+	/// Storage of the frames. A deque, so growing it keeps the frames in place.
+	std::deque<Frame> _pool;
+
+	/// Frames not in use
+	std::vector<Frame *> _free;
+
+	/// Frames waiting to be released, by generation
+	std::vector<Entry> _buffered;
+
+	unsigned long _late = 0;
+
+	unsigned long _early = 0;
+
+	unsigned long _dropped = 0;
+
+	/// Schedules the given frame and copies it in the buffer. If the pool is
+	/// full and cannot grow, the oldest buffered frame is dropped, or with
+	/// nothing buffered, the oldest released frame is reused.
+	void push(const Frame &frame, std::vector<Frame *> &released);
+
+	/// Gives a frame to copy in, growing the pool if the delay needs it
+	Frame * acquire(std::vector<Frame *> &released);
+
+};
+
+#endif /* JitterBuffer_hpp */
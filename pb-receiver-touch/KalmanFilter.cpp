@@ -0,0 +1,145 @@
+//
+//  KalmanFilter.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+
+#include "KalmanFilter.hpp"
+
+/// Shortest interval between two frames, in seconds
+static constexpr float minInterval = 1e-4f;
+
+/// Variance of the velocity of a joint starting over, in m²/s²
+static constexpr float initialVelocityVariance = 1.f;
+
+/// Lowest confidence a measurement is weighted with
+static constexpr float minConfidence = 1e-2f;
+
+void KalmanFilter::setParameters(const float &processNoise, const float &measurementNoise, const float &coastTime) {
+	_processNoise = std::max(processNoise, 0.f);
+	_measurementVariance = std::max(measurementNoise * measurementNoise, 1e-8f);
+	_coastTime = std::max(coastTime, 0.f);
+}
+
+void KalmanFilter::reset() {
+	resize(_slotCount);
+}
+
+void KalmanFilter::resize(const size_t &slotCount) {
+	const size_t joints = slotCount * Frame::jointCount;
+
+	_slotCount = slotCount;
+
+	_uids.assign(slotCount, pb::bodyUID());
+	_active.assign(slotCount, false);
+	_times.assign(slotCount, 0.);
+
+	for(std::vector<float> * component: {&_x, &_y, &_z, &_vx, &_vy, &_vz, &_p00, &_p01, &_p11, &_confidence}) {
+		component->assign(joints, 0.f);
+	}
+
+	_coasting.assign(joints, -1.f);
+}
+
+void KalmanFilter::filter(Frame &frame) {
+	if(frame.capacity() != _slotCount)
+		resize(frame.capacity());
+
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		const unsigned slot = frame.slots[b];
+		const size_t s0 = slot * Frame::jointCount;
+
+		// Start over when the slot changes hands
+		if(!_active[slot] || _uids[slot] != frame.uids[b]) {
+			_uids[slot] = frame.uids[b];
+			_active[slot] = true;
+			_times[slot] = frame.timestamp;
+
+			std::fill_n(_coasting.begin() + s0, Frame::jointCount, -1.f);
+		}
+
+		const float dt = std::max((float)(frame.timestamp - _times[slot]), minInterval);
+
+		_times[slot] = frame.timestamp;
+
+		// Process noise of a white acceleration over dt
+		const float q00 = _processNoise * dt * dt * dt / 3.f;
+		const float q01 = _processNoise * dt * dt / 2.f;
+		const float q11 = _processNoise * dt;
+
+		const size_t b0 = b * Frame::jointCount;
+
+		float * px = frame.positionX.data() + b0;
+		float * py = frame.positionY.data() + b0;
+		float * pz = frame.positionZ.data() + b0;
+		float * pc = frame.positionConfidence.data() + b0;
+
+		float * x = _x.data() + s0;
+		float * y = _y.data() + s0;
+		float * z = _z.data() + s0;
+		float * vx = _vx.data() + s0;
+		float * vy = _vy.data() + s0;
+		float * vz = _vz.data() + s0;
+		float * p00 = _p00.data() + s0;
+		float * p01 = _p01.data() + s0;
+		float * p11 = _p11.data() + s0;
+		float * coasting = _coasting.data() + s0;
+		float * confidence = _confidence.data() + s0;
+
+		for(size_t j = 0; j < Frame::jointCount; ++j) {
+			const bool measured = pc[j] > 0.f && pc[j] <= 1.f;
+			const bool tracked = coasting[j] >= 0.f;
+
+			// Predict
+			const float a00 = p00[j] + dt * (2.f * p01[j] + dt * p11[j]) + q00;
+			const float a01 = p01[j] + dt * p11[j] + q01;
+			const float a11 = p11[j] + q11;
+
+			x[j] += vx[j] * dt;
+			y[j] += vy[j] * dt;
+			z[j] += vz[j] * dt;
+
+			// Update, trusting the measurement less as its confidence drops.
+			// A joint starting over takes the measurement as is.
+			const float c = std::max(pc[j], minConfidence);
+			const float r = _measurementVariance / (c * c);
+			const float k0 = measured ? (tracked ? a00 / (a00 + r) : 1.f) : 0.f;
+			const float k1 = measured && tracked ? a01 / (a00 + r) : 0.f;
+
+			const float ex = px[j] - x[j];
+			const float ey = py[j] - y[j];
+			const float ez = pz[j] - z[j];
+
+			x[j] += k0 * ex;
+			y[j] += k0 * ey;
+			z[j] += k0 * ez;
+
+			vx[j] = tracked ? vx[j] + k1 * ex : 0.f;
+			vy[j] = tracked ? vy[j] + k1 * ey : 0.f;
+			vz[j] = tracked ? vz[j] + k1 * ez : 0.f;
+
+			p00[j] = tracked ? (1.f - k0) * a00 : r;
+			p01[j] = tracked ? (1.f - k0) * a01 : 0.f;
+			p11[j] = tracked ? a11 - k1 * a01 : initialVelocityVariance;
+
+			// Coast the joints that were not measured, until they expire
+			const float coast = measured ? 0.f : (tracked ? coasting[j] + dt : -1.f);
+			const bool expired = coast > _coastTime;
+
+			coasting[j] = expired ? -1.f : coast;
+			confidence[j] = measured ? pc[j] : confidence[j];
+
+			const bool output = measured || (tracked && !expired);
+
+			px[j] = output ? x[j] : px[j];
+			py[j] = output ? y[j] : py[j];
+			pz[j] = output ? z[j] : pz[j];
+
+			// Coasting joints fade out
+			pc[j] = measured || !output ? pc[j] : confidence[j] * (1.f - coast / std::max(_coastTime, minInterval));
+		}
+	}
+}
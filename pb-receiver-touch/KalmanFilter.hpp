@@ -0,0 +1,88 @@
+//
+//  KalmanFilter.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef KalmanFilter_hpp
+#define KalmanFilter_hpp
+
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Tracks the joints positions with a constant velocity Kalman filter.
+///
+/// Every joint has a position and a velocity on each axis, all axes sharing
+/// the same covariance. The measurement noise grows as the confidence of the
+/// joint drops, so poorly tracked joints barely move the estimate. Joints
+/// without confidence coast along their velocity for up to `coastTime`
+/// seconds, their confidence fading out, instead of collapsing to the origin.
+/// The state of each joint is kept by body slot, in structure of arrays, and
+/// starts over when the slot changes hands. Orientations are left untouched.
+/// Receive thread only.
+class KalmanFilter {
+public:
+
+	/// Sets the process noise, as the spectral density of the acceleration in
+	/// m²/s³, the measurement noise of a joint with full confidence, in meters,
+	/// and for how long joints without confidence coast, in seconds
+	void setParameters(const float &processNoise, const float &measurementNoise, const float &coastTime);
+
+	/// Forgets the state of all the slots
+	void reset();
+
+	/// Filters the bodies of the frame, in place
+	void filter(Frame &frame);
+
+private:
+
+	float _processNoise = 3;
+
+	/// Variance of a measurement with full confidence
+	float _measurementVariance = 4e-4f;
+
+	float _coastTime = .5f;
+
+	/// Number of slots the state is sized for
+	size_t _slotCount = 0;
+
+	// MARK: - State, by slot
+
+	/// Body currently owning the slot
+	std::vector<pb::bodyUID> _uids;
+
+	/// Tells if the slot has been filtered since it changed hands
+	std::vector<bool> _active;
+
+	/// Timestamp of the last frame filtered
+	std::vector<double> _times;
+
+	// MARK: - State, by joint, indexed by `slot * jointCount + joint`
+
+	/// Estimated positions and velocities
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+	std::vector<float> _vx;
+	std::vector<float> _vy;
+	std::vector<float> _vz;
+
+	/// Covariance of the position and velocity, shared by all axes
+	std::vector<float> _p00;
+	std::vector<float> _p01;
+	std::vector<float> _p11;
+
+	/// Time since the joint was last measured, in seconds. Negative if the
+	/// joint is not tracked and starts over at its next measurement.
+	std::vector<float> _coasting;
+
+	/// Confidence of the last measurement
+	std::vector<float> _confidence;
+
+	/// Sizes the state for the given number of slots and clears it
+	void resize(const size_t &slotCount);
+};
+
+#endif /* KalmanFilter_hpp */
@@ -0,0 +1,172 @@
+//
+//  MotionHistory.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+
+#include "MotionHistory.hpp"
+
+/// Longest gap in a slot's history before it is started over, in seconds
+static constexpr double maxGap = .5;
+
+/// Shortest interval between two frames to estimate a motion from, in seconds
+static constexpr double minInterval = 1e-4;
+
+void MotionHistory::reset() {
+	resize(_slotCount);
+}
+
+void MotionHistory::push(const Frame &frame) {
+	if(frame.capacity() != _slotCount)
+		resize(frame.capacity());
+
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		const unsigned slot = frame.slots[b];
+		const unsigned last = slot * historySize + _heads[slot];
+
+		// Start over when the slot changes hands, or after a long gap
+		if(_uids[slot] != frame.uids[b] || frame.timestamp - _times[last] > maxGap) {
+			_uids[slot] = frame.uids[b];
+			_counts[slot] = 0;
+		} else if(frame.timestamp - _times[last] < minInterval) {
+			continue;
+		}
+
+		// Store the body at the head of the history
+		const unsigned head = _counts[slot] == 0 ? 0 : (_heads[slot] + 1) % historySize;
+		const size_t h0 = (slot * historySize + head) * Frame::jointCount;
+		const size_t b0 = b * Frame::jointCount;
+
+		_heads[slot] = head;
+		_counts[slot] = std::min<unsigned>(_counts[slot] + 1, historySize);
+		_times[slot * historySize + head] = frame.timestamp;
+
+		std::copy_n(frame.positionX.begin() + b0, Frame::jointCount, _x.begin() + h0);
+		std::copy_n(frame.positionY.begin() + b0, Frame::jointCount, _y.begin() + h0);
+		std::copy_n(frame.positionZ.begin() + b0, Frame::jointCount, _z.begin() + h0);
+		std::copy_n(frame.positionConfidence.begin() + b0, Frame::jointCount, _confidence.begin() + h0);
+
+		// Estimate the motion of the joints
+		const size_t m0 = slot * Frame::jointCount;
+
+		if(_counts[slot] < 2) {
+			std::fill_n(_minConfidence.begin() + m0, Frame::jointCount, 0.f);
+			continue;
+		}
+
+		const unsigned k1 = (head + historySize - 1) % historySize;
+		const unsigned k2 = (head + historySize - 2) % historySize;
+		const size_t h1 = (slot * historySize + k1) * Frame::jointCount;
+		const size_t h2 = (slot * historySize + k2) * Frame::jointCount;
+
+		const double t0 = _times[slot * historySize + head];
+		const double t1 = _times[slot * historySize + k1];
+		const double t2 = _times[slot * historySize + k2];
+
+		const float inv01 = (float)(1. / (t0 - t1));
+
+		// Acceleration needs three frames
+		const bool accelerate = _counts[slot] > 2;
+		const float inv12 = accelerate ? (float)(1. / (t1 - t2)) : 0.f;
+		const float inv02 = accelerate ? (float)(2. / (t0 - t2)) : 0.f;
+
+		// Finite differences give the velocity between the frames, half an interval behind the last one
+		const float half01 = (float)(.5 * (t0 - t1));
+
+		for(size_t j = 0; j < Frame::jointCount; ++j) {
+			// Positions without confidence are not measures, a joint missing
+			// from one of the frames has no motion rather than a jump
+			const float tracked = _confidence[h0 + j] > 0.f && _confidence[h1 + j] > 0.f ? inv01 : 0.f;
+			const float accelerated = tracked > 0.f && _confidence[h2 + j] > 0.f ? inv02 : 0.f;
+
+			const float vx = (_x[h0 + j] - _x[h1 + j]) * tracked;
+			const float vy = (_y[h0 + j] - _y[h1 + j]) * tracked;
+			const float vz = (_z[h0 + j] - _z[h1 + j]) * tracked;
+
+			const float ax = (vx - (_x[h1 + j] - _x[h2 + j]) * inv12) * accelerated;
+			const float ay = (vy - (_y[h1 + j] - _y[h2 + j]) * inv12) * accelerated;
+			const float az = (vz - (_z[h1 + j] - _z[h2 + j]) * inv12) * accelerated;
+
+			_vx[m0 + j] = vx + ax * half01;
+			_vy[m0 + j] = vy + ay * half01;
+			_vz[m0 + j] = vz + az * half01;
+
+			_ax[m0 + j] = ax;
+			_ay[m0 + j] = ay;
+			_az[m0 + j] = az;
+
+			// Lowest confidence the motion was estimated from
+			float confidence = std::min(_confidence[h0 + j], _confidence[h1 + j]);
+			confidence = accelerate ? std::min(confidence, _confidence[h2 + j]) : confidence;
+
+			_minConfidence[m0 + j] = std::min(std::max(confidence, 0.f), 1.f);
+		}
+	}
+}
+
+bool MotionHistory::motion(const unsigned &slot, const pb::bodyUID &uid, Motion &motion) const {
+	if(slot >= _slotCount || _uids[slot] != uid || _counts[slot] < 2)
+		return false;
+
+	const size_t m0 = slot * Frame::jointCount;
+
+	motion.vx = _vx.data() + m0;
+	motion.vy = _vy.data() + m0;
+	motion.vz = _vz.data() + m0;
+	motion.ax = _ax.data() + m0;
+	motion.ay = _ay.data() + m0;
+	motion.az = _az.data() + m0;
+	motion.confidence = _minConfidence.data() + m0;
+
+	return true;
+}
+
+void MotionHistory::write(Frame &frame) const {
+	Motion motion;
+
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		const size_t b0 = b * Frame::jointCount;
+
+		if(!this->motion(frame.slots[b], frame.uids[b], motion)) {
+			for(std::vector<float> * component: {
+				&frame.velocityX, &frame.velocityY, &frame.velocityZ,
+				&frame.accelerationX, &frame.accelerationY, &frame.accelerationZ,
+				&frame.motionConfidence}) {
+				std::fill_n(component->begin() + b0, Frame::jointCount, 0.f);
+			}
+
+			continue;
+		}
+
+		std::copy_n(motion.vx, Frame::jointCount, frame.velocityX.begin() + b0);
+		std::copy_n(motion.vy, Frame::jointCount, frame.velocityY.begin() + b0);
+		std::copy_n(motion.vz, Frame::jointCount, frame.velocityZ.begin() + b0);
+		std::copy_n(motion.ax, Frame::jointCount, frame.accelerationX.begin() + b0);
+		std::copy_n(motion.ay, Frame::jointCount, frame.accelerationY.begin() + b0);
+		std::copy_n(motion.az, Frame::jointCount, frame.accelerationZ.begin() + b0);
+		std::copy_n(motion.confidence, Frame::jointCount, frame.motionConfidence.begin() + b0);
+	}
+}
+
+void MotionHistory::resize(const size_t &slotCount) {
+	const size_t historyJoints = slotCount * historySize * Frame::jointCount;
+	const size_t joints = slotCount * Frame::jointCount;
+
+	_slotCount = slotCount;
+
+	_uids.assign(slotCount, pb::bodyUID());
+	_counts.assign(slotCount, 0);
+	_heads.assign(slotCount, 0);
+	_times.assign(slotCount * historySize, 0.);
+
+	for(std::vector<float> * component: {&_x, &_y, &_z, &_confidence}) {
+		component->assign(historyJoints, 0.f);
+	}
+
+	for(std::vector<float> * component: {&_vx, &_vy, &_vz, &_ax, &_ay, &_az, &_minConfidence}) {
+		component->assign(joints, 0.f);
+	}
+}
@@ -0,0 +1,96 @@
+//
+//  MotionHistory.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef MotionHistory_hpp
+#define MotionHistory_hpp
+
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Keeps the last few positions of each body slot, and estimates from them
+/// the velocity and acceleration of every joint using the frames timestamps.
+///
+/// History is stored by slot in a ring sized once for all the slots, and
+/// starts over when a slot changes hands or after a long gap. The motion is
+/// updated incrementally, only for the bodies of the frame pushed. A joint
+/// without confidence in one of the frames its velocity or acceleration is
+/// estimated from gets a zero velocity or acceleration.
+class MotionHistory {
+public:
+
+	/// Motion of the joints of a body, `Frame::jointCount` values by component
+	struct Motion {
+		const float * vx;
+		const float * vy;
+		const float * vz;
+		const float * ax;
+		const float * ay;
+		const float * az;
+
+		/// Lowest confidence of each joint over the history, from 0 to 1
+		const float * confidence;
+	};
+
+	/// Forgets the history of all the slots
+	void reset();
+
+	/// Adds the bodies of the frame to the history and updates their motion
+	void push(const Frame &frame);
+
+	/// Gives the motion of the given body. Returns false if its motion is not known yet.
+	bool motion(const unsigned &slot, const pb::bodyUID &uid, Motion &motion) const;
+
+	/// Writes the motion of the bodies of the frame in its velocity,
+	/// acceleration and motion confidence components. Unknown motions are
+	/// written as zero.
+	void write(Frame &frame) const;
+
+private:
+
+	/// Number of frames kept in the history of each slot
+	static constexpr size_t historySize = 3;
+
+	/// Number of slots the history is sized for
+	size_t _slotCount = 0;
+
+	// MARK: - History, by slot
+
+	/// Body currently owning the slot
+	std::vector<pb::bodyUID> _uids;
+
+	/// Number of frames in the history
+	std::vector<unsigned> _counts;
+
+	/// Position of the last frame in the history
+	std::vector<unsigned> _heads;
+
+	/// Timestamp of each frame, indexed by `slot * historySize + k`
+	std::vector<double> _times;
+
+	/// Joints of each frame, indexed by `(slot * historySize + k) * jointCount + joint`
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+	std::vector<float> _confidence;
+
+	// MARK: - Motion, by slot
+
+	/// Motion of each joint at the last frame, indexed by `slot * jointCount + joint`
+	std::vector<float> _vx;
+	std::vector<float> _vy;
+	std::vector<float> _vz;
+	std::vector<float> _ax;
+	std::vector<float> _ay;
+	std::vector<float> _az;
+	std::vector<float> _minConfidence;
+
+	/// Resets the history for the given number of slots
+	void resize(const size_t &slotCount);
+};
+
+#endif /* MotionHistory_hpp */
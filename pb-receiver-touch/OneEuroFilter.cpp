@@ -0,0 +1,153 @@
+//
+//  OneEuroFilter.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "OneEuroFilter.hpp"
+
+/// Shortest interval between two frames, in seconds
+static constexpr float minInterval = 1e-4f;
+
+/// Smoothing factor of a low-pass filter with the given cutoff, for a sample every `dt` seconds
+static inline float smoothingFactor(const float &cutoff, const float &dt) {
+	const float tau = 1.f / (2.f * (float)M_PI * cutoff);
+	return 1.f / (1.f + tau / dt);
+}
+
+void OneEuroFilter::setParameters(const float &minCutoff, const float &beta, const float &derivativeCutoff) {
+	_minCutoff = std::max(minCutoff, 1e-3f);
+	_beta = std::max(beta, 0.f);
+	_derivativeCutoff = std::max(derivativeCutoff, 1e-3f);
+}
+
+void OneEuroFilter::reset() {
+	resize(_slotCount);
+}
+
+void OneEuroFilter::resize(const size_t &slotCount) {
+	const size_t joints = slotCount * Frame::jointCount;
+
+	_slotCount = slotCount;
+
+	_uids.assign(slotCount, pb::bodyUID());
+	_active.assign(slotCount, false);
+	_times.assign(slotCount, 0.);
+
+	for(std::vector<float> * component: {&_positionValid, &_orientationValid, &_x, &_y, &_z, &_qx, &_qy, &_qz, &_qw, &_dx, &_dy, &_dz, &_dq}) {
+		component->assign(joints, 0.f);
+	}
+}
+
+void OneEuroFilter::filter(Frame &frame) {
+	if(frame.capacity() != _slotCount)
+		resize(frame.capacity());
+
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		const unsigned slot = frame.slots[b];
+		const size_t s0 = slot * Frame::jointCount;
+
+		// Start over when the slot changes hands
+		if(!_active[slot] || _uids[slot] != frame.uids[b]) {
+			_uids[slot] = frame.uids[b];
+			_active[slot] = true;
+			_times[slot] = frame.timestamp;
+
+			std::fill_n(_positionValid.begin() + s0, Frame::jointCount, 0.f);
+			std::fill_n(_orientationValid.begin() + s0, Frame::jointCount, 0.f);
+		}
+
+		const float dt = std::max((float)(frame.timestamp - _times[slot]), minInterval);
+		const float invDt = 1.f / dt;
+		const float derivativeAlpha = smoothingFactor(_derivativeCutoff, dt);
+
+		_times[slot] = frame.timestamp;
+
+		const size_t b0 = b * Frame::jointCount;
+
+		float * px = frame.positionX.data() + b0;
+		float * py = frame.positionY.data() + b0;
+		float * pz = frame.positionZ.data() + b0;
+		float * ox = frame.orientationX.data() + b0;
+		float * oy = frame.orientationY.data() + b0;
+		float * oz = frame.orientationZ.data() + b0;
+		float * ow = frame.orientationW.data() + b0;
+		const float * pc = frame.positionConfidence.data() + b0;
+		const float * oc = frame.orientationConfidence.data() + b0;
+
+		float * pv = _positionValid.data() + s0;
+		float * ov = _orientationValid.data() + s0;
+		float * x = _x.data() + s0;
+		float * y = _y.data() + s0;
+		float * z = _z.data() + s0;
+		float * qx = _qx.data() + s0;
+		float * qy = _qy.data() + s0;
+		float * qz = _qz.data() + s0;
+		float * qw = _qw.data() + s0;
+		float * dx = _dx.data() + s0;
+		float * dy = _dy.data() + s0;
+		float * dz = _dz.data() + s0;
+		float * dq = _dq.data() + s0;
+
+		// Joints whose state starts over take the raw values: their
+		// derivative is zero and their smoothing factor one. Untracked
+		// joints are output as received.
+		for(size_t j = 0; j < Frame::jointCount; ++j) {
+			// Positions
+			const float pTracked = pc[j] > 0.f ? 1.f : 0.f;
+			const float p = pv[j] * pTracked;
+
+			dx[j] = (dx[j] + ((px[j] - x[j]) * invDt - dx[j]) * derivativeAlpha) * p;
+			dy[j] = (dy[j] + ((py[j] - y[j]) * invDt - dy[j]) * derivativeAlpha) * p;
+			dz[j] = (dz[j] + ((pz[j] - z[j]) * invDt - dz[j]) * derivativeAlpha) * p;
+
+			const float speed = std::sqrt(dx[j] * dx[j] + dy[j] * dy[j] + dz[j] * dz[j]);
+			const float positionAlpha = p > 0.f ? smoothingFactor(_minCutoff + _beta * speed, dt) : 1.f;
+
+			x[j] += (px[j] - x[j]) * positionAlpha;
+			y[j] += (py[j] - y[j]) * positionAlpha;
+			z[j] += (pz[j] - z[j]) * positionAlpha;
+
+			pv[j] = pTracked;
+			px[j] = x[j];
+			py[j] = y[j];
+			pz[j] = z[j];
+
+			// Orientations, going the short way around
+			const float oTracked = oc[j] > 0.f ? 1.f : 0.f;
+			const float o = ov[j] * oTracked;
+
+			float dot = qx[j] * ox[j] + qy[j] * oy[j] + qz[j] * oz[j] + qw[j] * ow[j];
+			const float sign = dot < 0.f && o > 0.f ? -1.f : 1.f;
+			dot = std::min(std::max(dot * sign, -1.f), 1.f);
+
+			dq[j] = (dq[j] + (2.f * std::acos(dot) * invDt - dq[j]) * derivativeAlpha) * o;
+
+			const float orientationAlpha = o > 0.f ? smoothingFactor(_minCutoff + _beta * dq[j], dt) : 1.f;
+
+			// Steps between two frames are small, a normalized lerp is close enough to a slerp
+			const float rx = qx[j] + (ox[j] * sign - qx[j]) * orientationAlpha;
+			const float ry = qy[j] + (oy[j] * sign - qy[j]) * orientationAlpha;
+			const float rz = qz[j] + (oz[j] * sign - qz[j]) * orientationAlpha;
+			const float rw = qw[j] + (ow[j] * sign - qw[j]) * orientationAlpha;
+
+			const float length = std::sqrt(rx * rx + ry * ry + rz * rz + rw * rw);
+			const float norm = length > 0.f ? 1.f / length : 0.f;
+
+			qx[j] = rx * norm;
+			qy[j] = ry * norm;
+			qz[j] = rz * norm;
+			qw[j] = rw * norm;
+
+			ov[j] = oTracked;
+			ox[j] = oTracked > 0.f ? qx[j] : ox[j];
+			oy[j] = oTracked > 0.f ? qy[j] : oy[j];
+			oz[j] = oTracked > 0.f ? qz[j] : oz[j];
+			ow[j] = oTracked > 0.f ? qw[j] : ow[j];
+		}
+	}
+}
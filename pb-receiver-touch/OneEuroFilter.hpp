@@ -0,0 +1,85 @@
+//
+//  OneEuroFilter.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef OneEuroFilter_hpp
+#define OneEuroFilter_hpp
+
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Smooths the joints with a One Euro filter: a low-pass filter whose cutoff
+/// rises with the speed of the joint, removing jitter at rest while keeping
+/// fast moves responsive.
+///
+/// Positions are filtered by component, with a cutoff driven by the speed of
+/// the joint. Orientations are filtered on the sphere, with a cutoff driven
+/// by the angular speed. The state of each joint is kept by body slot, in
+/// structure of arrays, and starts over when the slot changes hands. Joints
+/// without confidence are left as is and their state starts over. Receive
+/// thread only.
+class OneEuroFilter {
+public:
+
+	/// Sets the minimum cutoff and the derivative cutoff, in Hz, and how much
+	/// the cutoff rises with the speed
+	void setParameters(const float &minCutoff, const float &beta, const float &derivativeCutoff);
+
+	/// Forgets the state of all the slots
+	void reset();
+
+	/// Filters the bodies of the frame, in place
+	void filter(Frame &frame);
+
+private:
+
+	float _minCutoff = 1;
+
+	float _beta = 0;
+
+	float _derivativeCutoff = 1;
+
+	/// Number of slots the state is sized for
+	size_t _slotCount = 0;
+
+	// MARK: - State, by slot
+
+	/// Body currently owning the slot
+	std::vector<pb::bodyUID> _uids;
+
+	/// Tells if the slot has been filtered since it changed hands
+	std::vector<bool> _active;
+
+	/// Timestamp of the last frame filtered
+	std::vector<double> _times;
+
+	// MARK: - State, by joint, indexed by `slot * jointCount + joint`
+
+	/// 1 if the joint has been filtered since its state started over, 0 otherwise
+	std::vector<float> _positionValid;
+	std::vector<float> _orientationValid;
+
+	/// Last filtered values
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+	std::vector<float> _qx;
+	std::vector<float> _qy;
+	std::vector<float> _qz;
+	std::vector<float> _qw;
+
+	/// Filtered derivatives
+	std::vector<float> _dx;
+	std::vector<float> _dy;
+	std::vector<float> _dz;
+	std::vector<float> _dq;
+
+	/// Sizes the state for the given number of slots and clears it
+	void resize(const size_t &slotCount);
+};
+
+#endif /* OneEuroFilter_hpp */
@@ -0,0 +1,177 @@
+//
+//  ReceiverHub.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+#include <condition_variable>
+
+#include <pb-common/Structs/Body.hpp>
+
+#include "ReceiverHub.hpp"
+
+constexpr size_t ReceiverHub::maxBodies;
+
+/// Guards the shared hub
+static std::mutex sharedMutex;
+
+/// Hub of the process, alive as long as an op holds it
+static std::weak_ptr<ReceiverHub> sharedHub;
+
+/// Serializes the opening and closing of the receivers, so a hub opening
+/// never overlaps with a previous one closing
+static std::mutex lifecycleMutex;
+
+/// Deletes the hubs released by the ops on a worker thread, as closing a
+/// receiver blocks. The worker is joined when the plugin is unloaded, once
+/// all the hubs given to it are closed.
+class HubCloser {
+public:
+
+	~HubCloser() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+
+		_condition.notify_one();
+
+		if(_worker.joinable())
+			_worker.join();
+	}
+
+	void close(ReceiverHub * hub) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_hubs.push_back(hub);
+
+		if(!_worker.joinable())
+			_worker = std::thread(&HubCloser::run, this);
+
+		_condition.notify_one();
+	}
+
+private:
+
+	std::mutex _mutex;
+
+	std::condition_variable _condition;
+
+	/// Hubs waiting to be closed
+	std::vector<ReceiverHub *> _hubs;
+
+	bool _stopping = false;
+
+	std::thread _worker;
+
+	void run() {
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		while(true) {
+			_condition.wait(lock, [this] { return _stopping || !_hubs.empty(); });
+
+			if(_hubs.empty())
+				return;
+
+			ReceiverHub * hub = _hubs.back();
+			_hubs.pop_back();
+
+			lock.unlock();
+			delete hub;
+			lock.lock();
+		}
+	}
+};
+
+/// Declared after the lifecycle mutex, so it is destroyed, and the hubs
+/// closed, before the mutex goes away
+static HubCloser hubCloser;
+
+std::shared_ptr<ReceiverHub> ReceiverHub::shared() {
+	std::lock_guard<std::mutex> lock(sharedMutex);
+
+	std::shared_ptr<ReceiverHub> hub = sharedHub.lock();
+
+	if(!hub) {
+		// Closing the receiver blocks, the last op to leave does not wait for it
+		hub = std::shared_ptr<ReceiverHub>(new ReceiverHub(), [] (ReceiverHub * hub) {
+			hubCloser.close(hub);
+		});
+
+		sharedHub = hub;
+	}
+
+	return hub;
+}
+
+ReceiverHub::ReceiverHub() {
+	_snapshot.reserve(maxBodies);
+
+	// Setting up the sockets and the discovery blocks, do it in the
+	// background. Until then, ops output empty frames.
+	_startup = std::thread([this] {
+		std::lock_guard<std::mutex> lock(lifecycleMutex);
+
+		_receiver.open();
+		_receiver.addObserver(this);
+	});
+}
+
+ReceiverHub::~ReceiverHub() {
+	_startup.join();
+
+	std::lock_guard<std::mutex> lock(lifecycleMutex);
+	_receiver.close();
+}
+
+void ReceiverHub::addObserver(Observer * observer) {
+	std::lock_guard<std::mutex> lock(_observersMutex);
+	_observers.push_back(observer);
+}
+
+void ReceiverHub::removeObserver(Observer * observer) {
+	std::lock_guard<std::mutex> lock(_observersMutex);
+	_observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+}
+
+// MARK: - PB Receiver Observer
+
+void ReceiverHub::receiverDidConnect(pb::PBReceiver *) {
+	_connected.store(true, std::memory_order_relaxed);
+}
+
+void ReceiverHub::receiverDidUpdate(pb::PBReceiver *) {
+	std::lock_guard<std::mutex> lock(_observersMutex);
+
+	if(std::all_of(_observers.begin(), _observers.end(), [] (Observer * observer) { return observer->isIdle(); }))
+		return;
+
+	// Copy the arena once for all the observers
+	_snapshot.clear();
+	_snapshot.timestamp = Frame::now();
+
+	_receiver.arena()->lock();
+
+	for(pb::Body * body: _receiver.arena()->getSubset()) {
+		// Bodies past the maximum are ignored
+		if(!_snapshot.push(*body))
+			break;
+	}
+
+	_receiver.arena()->unlock();
+
+	for(Observer * observer: _observers) {
+		observer->hubDidUpdate(this, _snapshot);
+	}
+}
+
+void ReceiverHub::receiverDidClose(pb::PBReceiver *) {
+	_connected.store(false, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(_observersMutex);
+
+	for(Observer * observer: _observers) {
+		observer->hubDidClose(this);
+	}
+}
@@ -0,0 +1,96 @@
+//
+//  ReceiverHub.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef ReceiverHub_hpp
+#define ReceiverHub_hpp
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pb-common/common.hpp>
+#include <pb-common/Utils/PBReceiver.hpp>
+
+#include "Frame.hpp"
+
+/// A receiver shared by all the ops of the process.
+///
+/// The hub owns the only link to the master. On every update, it copies the
+/// arena once in a snapshot, and hands that snapshot to all its observers,
+/// each building its own frames from it with its own settings. The hub is
+/// reference counted: it is opened by the first op asking for it, and closed
+/// when the last one releases it. Opening and closing both happen in the
+/// background, so neither blocks the thread creating or destroying the ops.
+class ReceiverHub final: public pb::PBReceiverObserver {
+public:
+
+	/// Receives the hub events, on its receive thread
+	class Observer {
+	public:
+		virtual ~Observer() = default;
+
+		/// The snapshot is only valid for the duration of the call
+		virtual void hubDidUpdate(ReceiverHub * hub, const Frame &snapshot) = 0;
+
+		virtual void hubDidClose(ReceiverHub * hub) = 0;
+
+		/// Tells if the observer skips the updates for now. When all the
+		/// observers are idle, the hub does not copy the arena.
+		virtual bool isIdle() const {
+			return false;
+		}
+	};
+
+	/// Maximum number of bodies in a snapshot
+	static constexpr size_t maxBodies = 128;
+
+	/// Gives the hub of the process, opening it in the background if nobody holds it
+	static std::shared_ptr<ReceiverHub> shared();
+
+	~ReceiverHub();
+
+	void addObserver(Observer * observer);
+
+	/// Removes the observer. Once this returns, the observer will not be called anymore
+	void removeObserver(Observer * observer);
+
+	inline bool isConnected() const {
+		return _connected.load(std::memory_order_relaxed);
+	}
+
+	// MARK: - PB Receiver Observer
+
+	virtual void receiverDidConnect(pb::PBReceiver *) override;
+
+	virtual void receiverDidUpdate(pb::PBReceiver *) override;
+
+	virtual void receiverDidClose(pb::PBReceiver *) override;
+
+private:
+
+	ReceiverHub();
+
+	/// Link to the master
+	pb::PBReceiver _receiver;
+
+	/// Opens the receiver
+	std::thread _startup;
+
+	std::atomic<bool> _connected {false};
+
+	/// Guards the observers, held while they are called
+	std::mutex _observersMutex;
+
+	std::vector<Observer *> _observers;
+
+	/// Copy of the arena, handed to the observers. Receive thread only.
+	Frame _snapshot;
+};
+
+#endif /* ReceiverHub_hpp */
@@ -0,0 +1,161 @@
+//
+//  Resampler.cpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "Resampler.hpp"
+
+Resampler::Resampler(): _samples(maxSamples) {}
+
+void Resampler::setRate(const double &rate) {
+	if(rate == _rate)
+		return;
+
+	// Start over at the next frame
+	_rate = rate;
+	_hasPrevious = false;
+	_lastSample = nullptr;
+}
+
+void Resampler::process(const std::vector<Frame *> &frames, const size_t &received, std::vector<Frame *> &samples) {
+	samples.clear();
+
+	const double period = 1. / _rate;
+
+	for(size_t f = frames.size() - received; f < frames.size(); ++f) {
+		const Frame &frame = *frames[f];
+
+		// Start over on the first frame, after a layout change, or after a
+		// gap too long to interpolate over. The samples already produced are
+		// dropped, they may not share the layout of the next ones.
+		if(!_hasPrevious ||
+		   frame.capacity() != _previous.capacity() ||
+		   frame.timestamp - _next > maxSamples * period) {
+			_next = frame.timestamp;
+			_lastSample = nullptr;
+			samples.clear();
+			setPrevious(frame);
+			continue;
+		}
+
+		while(_next <= frame.timestamp && samples.size() < maxSamples) {
+			Frame &sample = _samples[_nextSample];
+			_nextSample = (_nextSample + 1) % maxSamples;
+
+			interpolate(frame, _next, sample);
+			samples.push_back(&sample);
+
+			_next += period;
+		}
+
+		setPrevious(frame);
+	}
+
+	if(!samples.empty()) {
+		_lastSample = samples.back();
+	} else if(_lastSample) {
+		samples.push_back(_lastSample);
+	}
+}
+
+void Resampler::setPrevious(const Frame &frame) {
+	_previous.assign(frame);
+	_hasPrevious = true;
+
+	// Index the bodies by slot, to match them with the next frame
+	_previousBodies.assign(frame.capacity(), -1);
+
+	for(size_t b = 0; b < frame.bodyCount; ++b) {
+		_previousBodies[frame.slots[b]] = (int)b;
+	}
+}
+
+void Resampler::interpolate(const Frame &next, const double &t, Frame &sample) {
+	if(sample.capacity() != next.capacity())
+		sample.reserve(next.capacity());
+
+	const double span = next.timestamp - _previous.timestamp;
+	const float alpha = span > 0 ? (float)std::min(std::max((t - _previous.timestamp) / span, 0.), 1.) : 1.f;
+
+	sample.clear();
+	sample.generation = next.generation;
+	sample.timestamp = t;
+	sample.bodyCount = next.bodyCount;
+
+	std::copy_n(next.uids.begin(), next.bodyCount, sample.uids.begin());
+	std::copy_n(next.slots.begin(), next.bodyCount, sample.slots.begin());
+
+	for(size_t b = 0; b < next.bodyCount; ++b) {
+		const int previous = _previousBodies[next.slots[b]];
+
+		// Bodies that just appeared have nothing to be interpolated with
+		const Frame &from = previous < 0 ? next : _previous;
+		const size_t a0 = (previous < 0 ? b : (size_t)previous) * Frame::jointCount;
+		const size_t b0 = b * Frame::jointCount;
+
+		for(size_t j = 0; j < Frame::jointCount; ++j) {
+			const size_t ia = a0 + j;
+			const size_t ib = b0 + j;
+
+			// Joints without confidence on one side snap to the nearest frame
+			const bool posValid = from.positionConfidence[ia] > 0.f && next.positionConfidence[ib] > 0.f;
+			const float pa = posValid ? alpha : std::round(alpha);
+
+			sample.positionX[ib] = from.positionX[ia] + (next.positionX[ib] - from.positionX[ia]) * pa;
+			sample.positionY[ib] = from.positionY[ia] + (next.positionY[ib] - from.positionY[ia]) * pa;
+			sample.positionZ[ib] = from.positionZ[ia] + (next.positionZ[ib] - from.positionZ[ia]) * pa;
+			sample.positionConfidence[ib] = pa < .5f ? from.positionConfidence[ia] : next.positionConfidence[ib];
+
+			sample.velocityX[ib] = from.velocityX[ia] + (next.velocityX[ib] - from.velocityX[ia]) * pa;
+			sample.velocityY[ib] = from.velocityY[ia] + (next.velocityY[ib] - from.velocityY[ia]) * pa;
+			sample.velocityZ[ib] = from.velocityZ[ia] + (next.velocityZ[ib] - from.velocityZ[ia]) * pa;
+			sample.accelerationX[ib] = from.accelerationX[ia] + (next.accelerationX[ib] - from.accelerationX[ia]) * pa;
+			sample.accelerationY[ib] = from.accelerationY[ia] + (next.accelerationY[ib] - from.accelerationY[ia]) * pa;
+			sample.accelerationZ[ib] = from.accelerationZ[ia] + (next.accelerationZ[ib] - from.accelerationZ[ia]) * pa;
+			sample.motionConfidence[ib] = std::min(from.motionConfidence[ia], next.motionConfidence[ib]);
+
+			const bool orValid = from.orientationConfidence[ia] > 0.f && next.orientationConfidence[ib] > 0.f;
+			const float oa = orValid ? alpha : std::round(alpha);
+
+			// Slerp, going the short way around
+			float qx = next.orientationX[ib], qy = next.orientationY[ib], qz = next.orientationZ[ib], qw = next.orientationW[ib];
+			float dot = from.orientationX[ia] * qx + from.orientationY[ia] * qy + from.orientationZ[ia] * qz + from.orientationW[ia] * qw;
+
+			if(dot < 0.f) {
+				qx = -qx; qy = -qy; qz = -qz; qw = -qw;
+				dot = -dot;
+			}
+
+			float wa = 1.f - oa;
+			float wb = oa;
+
+			// Nearly identical orientations are linearly interpolated
+			if(dot < .9995f) {
+				const float theta = std::acos(dot);
+				const float sinTheta = std::sin(theta);
+
+				wa = std::sin(wa * theta) / sinTheta;
+				wb = std::sin(wb * theta) / sinTheta;
+			}
+
+			float rx = from.orientationX[ia] * wa + qx * wb;
+			float ry = from.orientationY[ia] * wa + qy * wb;
+			float rz = from.orientationZ[ia] * wa + qz * wb;
+			float rw = from.orientationW[ia] * wa + qw * wb;
+
+			const float length = std::sqrt(rx * rx + ry * ry + rz * rz + rw * rw);
+			const float norm = length > 0.f ? 1.f / length : 0.f;
+
+			sample.orientationX[ib] = rx * norm;
+			sample.orientationY[ib] = ry * norm;
+			sample.orientationZ[ib] = rz * norm;
+			sample.orientationW[ib] = rw * norm;
+			sample.orientationConfidence[ib] = oa < .5f ? from.orientationConfidence[ia] : next.orientationConfidence[ib];
+		}
+	}
+}
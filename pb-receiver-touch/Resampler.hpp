@@ -0,0 +1,75 @@
+//
+//  Resampler.hpp
+//  pb-receiver-touch
+//
+//  Created by agent on 2026-10-17.
+//
+
+#ifndef Resampler_hpp
+#define Resampler_hpp
+
+#include <vector>
+
+#include "Frame.hpp"
+
+/// Resamples the received frames at a fixed rate, using their timestamps.
+///
+/// Samples are taken at evenly spaced instants between the frames received,
+/// positions are linearly interpolated and orientations spherically
+/// interpolated. Bodies are matched between frames by slot. A sample can only
+/// be produced once the frame following its instant has been received, so
+/// the output lags the stream by up to one frame. Cook thread only.
+class Resampler {
+public:
+
+	Resampler();
+
+	/// Sets the output rate, in samples per second
+	void setRate(const double &rate);
+
+	inline double rate() const {
+		return _rate;
+	}
+
+	/// Consumes the last `received` frames of `frames`, and replaces the
+	/// content of `samples` with the samples due, oldest first. If no sample
+	/// is due, the last one is output again. All the samples share the
+	/// capacity of the last frame consumed.
+	void process(const std::vector<Frame *> &frames, const size_t &received, std::vector<Frame *> &samples);
+
+private:
+
+	/// Maximum number of samples produced by a single call to `process`
+	static constexpr size_t maxSamples = 32;
+
+	double _rate = 0;
+
+	/// Instant of the next sample
+	double _next = 0;
+
+	/// Last frame received, start of the current interpolation segment
+	Frame _previous;
+
+	/// Tells if `_previous` holds a frame
+	bool _hasPrevious = false;
+
+	/// Storage for the samples
+	std::vector<Frame> _samples;
+
+	/// Index of the next sample storage to use
+	size_t _nextSample = 0;
+
+	/// Last sample produced
+	Frame * _lastSample = nullptr;
+
+	/// Index of each slot's body in `_previous`, or -1
+	std::vector<int> _previousBodies;
+
+	/// Copies the given frame as the start of the next segment
+	void setPrevious(const Frame &frame);
+
+	/// Writes in `sample` the state at instant `t` between `_previous` and `next`
+	void interpolate(const Frame &next, const double &t, Frame &sample);
+};
+
+#endif /* Resampler_hpp */